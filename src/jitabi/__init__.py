@@ -29,11 +29,19 @@ first call for a given *(module_name, abi_hash)* pair; subsequent calls reuse
 artifacts stored in ``~/.jitabi`` (or the path you pass as *cache_path*).
 
 '''
+import random
 import logging
 import hashlib
+import threading
 
 from types import ModuleType
+from typing import (
+    Callable,
+    Iterable
+)
 from pathlib import Path
+from dataclasses import replace
+from concurrent.futures import Future, ThreadPoolExecutor
 
 from antelope_rs import ABIView
 
@@ -45,6 +53,16 @@ from jitabi.cache import (
     Cache
 )
 from jitabi.compiler import compile_module
+from jitabi.fallback import ABIFallback, AsyncModule
+from jitabi.runtime import load_runtime
+from jitabi.incremental import (
+    CompositeModule,
+    SubsetABI,
+    changed_types,
+    type_hashes,
+    read_type_hashes,
+    write_type_hashes
+)
 from jitabi.utils import detect_working_compiler
 
 
@@ -70,6 +88,70 @@ def hash_abi_for_cache(
     )
 
 
+# pgo training input: `(type_name, raw)` pairs to decode (and re-encode
+# when packing is enabled), or a callable driving the instrumented module
+PGOSample = Iterable[tuple[str, bytes]] | Callable[[ModuleType], None]
+
+
+def random_payloads(
+    abi: ABIView,
+    type_names: Iterable[str],
+    *,
+    rng: random.Random
+) -> list[tuple[str, bytes]]:
+    '''
+    `(type_name, raw)` for a random value of each entry in *type_names*, in
+    order. Backs the pgo samples & `jitabi.bench` payloads.
+
+    '''
+    return [
+        (type_name, abi.pack(type_name, abi.random_of(type_name, rng=rng)))
+        for type_name in type_names
+    ]
+
+
+def random_sample(
+    abi: ABIView,
+    *,
+    rounds: int = 16,
+    seed: int = 0
+) -> Iterable[tuple[str, bytes]]:
+    '''
+    Default pgo sample, `rounds` random values of every struct & variant in
+    *abi*.
+
+    '''
+    names = [s.name for s in abi.structs] + [v.name for v in abi.variants]
+    return random_payloads(abi, names * rounds, rng=random.Random(seed))
+
+
+def stats_sample(
+    abi: ABIView,
+    stats: dict,
+    *,
+    size: int = 1024,
+    seed: int = 0
+) -> list[tuple[str, bytes]]:
+    '''
+    Pgo sample shaped like live traffic, *size* random values of the types
+    a `stats` build counted, each type drawn in proportion to its `ticks`
+    (`calls` on counters only builds) over both directions.
+
+    '''
+    weights: dict[str, int] = {}
+    for types in stats.values():
+        for type_name, counters in types.items():
+            weight = counters.get('ticks') or counters['calls']
+            weights[type_name] = weights.get(type_name, 0) + weight
+
+    if not weights:
+        return []
+
+    rng = random.Random(seed)
+    names = rng.choices(list(weights), weights=list(weights.values()), k=size)
+    return random_payloads(abi, names, rng=rng)
+
+
 class JITContext:
     '''
     Encapsulates caching + codegen + compilation.
@@ -95,15 +177,34 @@ class JITContext:
             f'Initialized JITContext with cache at {self._cache.fs_location}'
         )
 
+        # generated modules bind the shared runtime when they're imported
+        if load_runtime(self._cache, build=not readonly) is None:
+            logger.warning(
+                'jitabi runtime not found in read only cache, modules built '
+                'against it will fail to import'
+            )
+
         self._versions: dict = {}
 
+        # composed modules by the key they stand in for, see `_incremental_module`
+        self._composites: dict[CacheKey, CompositeModule] = {}
+
+        # background compiles, see `module_for_abi_async`
+        self._executor: ThreadPoolExecutor | None = None
+        self._pending: dict[CacheKey, Future] = {}
+        # also guards `_versions`, bumped from the build thread
+        self._pending_lock = threading.Lock()
+
     def _full_mod_name(self, name: str) -> str:
         name = name.replace('.', '_')
-        return f'{name}_{self._versions.setdefault(name, 0)}'
+        with self._pending_lock:
+            return f'{name}_{self._versions.setdefault(name, 0)}'
 
     def _inc_mod_name(self, name: str):
         name = name.replace('.', '_')
-        self._versions[name] += 1
+        # background builds bump versions too, see `module_for_abi_async`
+        with self._pending_lock:
+            self._versions[name] += 1
 
     def _source_from_abi(
         self,
@@ -130,7 +231,8 @@ class JITContext:
         logger.debug(f'Generating new C source for {key})')
         source = codegen.c_source_from_abi(
             key.mod_name,
-            abi
+            abi,
+            params=key.params
         )
 
         self._cache.set_abi_source(key, source)
@@ -142,6 +244,7 @@ class JITContext:
         source: str,
         *,
         force_reload: bool = False,
+        profile_dir: Path | None = None,
     ) -> ModuleType:
         '''
         Ensure compiled extension for *(mod_name, src_hash)* exists and return
@@ -170,7 +273,8 @@ class JITContext:
                 key.mod_name,
                 source,
                 output_dir,
-                key.params
+                key.params,
+                profile_dir=profile_dir
             )
 
         module = self._cache.get_module(key, force_reload=True)
@@ -189,28 +293,97 @@ class JITContext:
     def module_dir_for(self, key: CacheKey) -> Path:
         return self._cache.get_module_path(key)
 
+    def _train_profile(
+        self,
+        key: CacheKey,
+        abi: ABIView,
+        sample: PGOSample | None,
+        *,
+        force_reload: bool = False,
+    ) -> Path:
+        '''
+        Build the instrumented twin of the `pgo='use'` *key*, run *sample*
+        through it and return the directory holding the profile it wrote.
+
+        '''
+        gen_params = replace(key.params, pgo='generate')
+        gen_key = CacheKey(
+            mod_name=key.mod_name,
+            src_hash=hash_abi_for_cache(abi, gen_params),
+            params=gen_params
+        )
+        profile_dir = self.module_dir_for(gen_key) / 'profile'
+
+        logger.info(f'Training profile for {key} with {gen_key}')
+        source = self._source_from_abi(gen_key, abi, force_reload=force_reload)
+        module = self._compile_module(
+            gen_key, source,
+            force_reload=force_reload,
+            profile_dir=profile_dir
+        )
+
+        # start from a clean profile, flush & reset whatever the module
+        # counted so far (import, earlier samples) and drop older files
+        module._pgo_dump()
+        for stale in ('*.gcda', '*.profraw', '*.profdata'):
+            for p in profile_dir.rglob(stale):
+                p.unlink()
+
+        if sample is None:
+            sample = random_sample(abi)
+
+        if callable(sample):
+            sample(module)
+
+        else:
+            for type_name, raw in sample:
+                value = module.unpack(type_name, raw)
+                if gen_params.with_pack:
+                    module.pack(type_name, value)
+
+        module._pgo_dump()
+        return profile_dir
+
+    def _key_for_abi(
+        self,
+        name: str,
+        abi: ABIView,
+        params: ModuleParams
+    ) -> CacheKey:
+        return CacheKey(
+            mod_name=self._full_mod_name(name),
+            src_hash=hash_abi_for_cache(abi, params),
+            params=params
+        )
+
     def module_for_abi(
         self,
         name: str,
         abi: ABIView,
         *,
         force_reload: bool = False,
-        params: dict | ModuleParams = {}
-    ) -> tuple[CacheKey, ModuleType]:
+        params: dict | ModuleParams = {},
+        pgo_sample: PGOSample | None = None,
+        incremental: bool = False
+    ) -> tuple[CacheKey, ModuleType | CompositeModule]:
         '''
         Return a compiled extension for *abi*, compiling it if necessary.
 
+        With `params={'pgo': 'use'}` an instrumented build of the module is
+        trained on *pgo_sample* first, either `(type_name, raw)` pairs or a
+        callable receiving the instrumented module, defaults to
+        `random_sample`.
+
+        With *incremental*, a module built for an earlier version of the ABI
+        under the same *name* & params is reused for its unchanged types and
+        only the changed ones get compiled, see `jitabi.incremental`. The
+        result is then a `CompositeModule`.
+
         '''
         params: ModuleParams = ModuleParams.from_dict(params)
         abi = ABIView.from_abi(abi)
 
-        full_name = self._full_mod_name(name)
-        src_hash = hash_abi_for_cache(abi, params)
-        key = CacheKey(
-            mod_name=full_name,
-            src_hash=src_hash,
-            params=params
-        )
+        key = self._key_for_abi(name, abi, params)
         logger.debug(f'Requesting module for {key})')
 
         module = self._cache.get_module(key, force_reload=force_reload)
@@ -221,6 +394,36 @@ class JITContext:
                 )
                 return key, module
 
+            if incremental and params.pgo == 'off':
+                composite = self._composites.get(key, None)
+                if composite is None:
+                    composite = self._incremental_module(key, abi)
+
+                if composite is not None:
+                    self._composites[key] = composite
+                    return key, composite
+
+        return self._build_module(
+            key, name, abi, params,
+            force_reload=force_reload,
+            pgo_sample=pgo_sample
+        )
+
+    def _build_module(
+        self,
+        key: CacheKey,
+        name: str,
+        abi: ABIView,
+        params: ModuleParams,
+        *,
+        force_reload: bool = False,
+        pgo_sample: PGOSample | None = None
+    ) -> tuple[CacheKey, ModuleType]:
+        '''
+        Compile *abi* into the module for *key*, as computed by
+        `_key_for_abi` when the build was requested.
+
+        '''
         if self.is_readonly:
             raise RuntimeError('Module not cached and in read only context!')
 
@@ -234,15 +437,158 @@ class JITContext:
         abi_location = mod_dir / f'{name}.json'
         abi_location.write_text(str(abi.definition))
 
+        profile_dir: Path | None = None
+        if params.pgo == 'use':
+            profile_dir = self._train_profile(
+                key, abi, pgo_sample,
+                force_reload=force_reload
+            )
+
         source = self._source_from_abi(
             key, abi,
             force_reload=force_reload
         )
 
-        return (
-            key,
-            self._compile_module(
-                key, source,
-                force_reload=force_reload,
+        module = self._compile_module(
+            key, source,
+            force_reload=force_reload,
+            profile_dir=profile_dir
+        )
+
+        # lets later versions of the ABI build on this module
+        write_type_hashes(mod_dir, abi, codegen.hash_pipeline(as_bytes=False))
+
+        return key, module
+
+    def _incremental_module(
+        self,
+        key: CacheKey,
+        abi: ABIView
+    ) -> CompositeModule | None:
+        '''
+        Compose *key*'s module out of the cached module sharing the most
+        types with *abi* and a delta module holding the rest, `None` when no
+        cached module shares any.
+
+        '''
+        pipeline = codegen.hash_pipeline(as_bytes=False)
+        hashes = type_hashes(abi)
+
+        base_key: CacheKey | None = None
+        base_types: set[str] = set()
+        delta: set[str] = set(hashes)
+        for candidate in self._cache.keys_for(key):
+            base_hashes = read_type_hashes(
+                self.module_dir_for(candidate), pipeline)
+            if base_hashes is None:
+                continue
+
+            changed = changed_types(base_hashes, hashes)
+            if len(changed) < len(delta):
+                base_key, delta = candidate, changed
+                base_types = set(base_hashes)
+
+        if base_key is None:
+            return None
+
+        base = self._cache.get_module(base_key)
+        if base is None:
+            return None
+
+        delta_module: ModuleType | None = None
+        if delta:
+            subset = SubsetABI(abi, delta)
+
+            h = hashlib.sha256()
+            h.update(pipeline.encode())
+            h.update(base_key.src_hash.encode())
+            h.update(key.params.as_bytes())
+            for name in sorted(subset.names):
+                h.update(f'{name}:{hashes[name]}'.encode())
+
+            delta_key = CacheKey(
+                mod_name=f'{key.mod_name}_delta',
+                src_hash=h.hexdigest(),
+                params=key.params
             )
+            logger.info(
+                f'Building {key} on top of {base_key}, '
+                f'{len(delta)} changed types'
+            )
+            source = self._source_from_abi(delta_key, subset)
+            delta_module = self._compile_module(delta_key, source)
+
+        return CompositeModule(
+            base, delta_module, delta, set(hashes),
+            removed=base_types - set(hashes)
         )
+
+    def module_for_abi_async(
+        self,
+        name: str,
+        abi: ABIView,
+        *,
+        params: dict | ModuleParams = {},
+        pgo_sample: PGOSample | None = None
+    ) -> AsyncModule:
+        '''
+        Non blocking `module_for_abi`: return an `AsyncModule` right away,
+        decoding through `antelope_rs` until the compiled module can be
+        imported, then switching over to it.
+
+        Cached modules are returned already switched over. Otherwise the
+        build runs on a background thread, one build at a time per context,
+        and concurrent requests for the same key share it. The build future
+        is `AsyncModule.future`.
+
+        The fallback only produces `dict` shaped values, other output modes
+        would change shape mid stream and raise `ValueError`.
+
+        '''
+        params: ModuleParams = ModuleParams.from_dict(params)
+        if params.output != ABIFallback.output:
+            raise ValueError(
+                f'module_for_abi_async only supports {ABIFallback.output!r} '
+                f'output, got {params.output!r}'
+            )
+
+        abi = ABIView.from_abi(abi)
+
+        key = self._key_for_abi(name, abi, params)
+        fallback = ABIFallback(abi)
+
+        module = self._cache.get_module(key)
+        if module is not None:
+            done: Future = Future()
+            done.set_result((key, module))
+            return AsyncModule(done, fallback)
+
+        if self.is_readonly:
+            raise RuntimeError('Module not cached and in read only context!')
+
+        with self._pending_lock:
+            future = self._pending.get(key)
+            if future is None:
+                if self._executor is None:
+                    self._executor = ThreadPoolExecutor(
+                        max_workers=1,
+                        thread_name_prefix='jitabi-compile'
+                    )
+
+                logger.info(f'Compiling {key} in the background')
+                # build under the key requested here, the name version
+                # might have moved by the time the executor gets to it
+                future = self._executor.submit(
+                    self._build_module,
+                    key, name, abi, params,
+                    pgo_sample=pgo_sample
+                )
+                self._pending[key] = future
+                future.add_done_callback(
+                    lambda _: self._drop_pending(key))
+
+        return AsyncModule(future, fallback)
+
+    def _drop_pending(self, key: CacheKey) -> None:
+        with self._pending_lock:
+            self._pending.pop(key, None)
@@ -0,0 +1,240 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Command line entry point, `python -m jitabi <command>` or `jitabi <command>`.
+
+* `build`: compile modules ahead of time into a cache directory that can be
+  shipped with a deployment image, then opened with
+  `JITContext(cache_path=..., readonly=True)` so the compiler never runs at
+  runtime.
+* `bench`: benchmark the module of an ABI on random or captured payloads of
+  some of its types, across output modes and against `antelope_rs`.
+
+'''
+from __future__ import annotations
+
+import sys
+import logging
+import argparse
+
+from pathlib import Path
+
+from antelope_rs import ABIView
+
+import jitabi.bench as bench
+
+from jitabi import JITContext
+from jitabi.cache import (
+    ModuleParams,
+    output_modes,
+    pgo_modes,
+    stats_modes
+)
+
+
+logger = logging.getLogger(__name__)
+
+
+def build_bundle(
+    abi_paths: list[Path],
+    out: Path,
+    params: ModuleParams,
+    *,
+    names: list[str] | None = None,
+    force_reload: bool = False
+) -> None:
+    '''
+    Compile one module per ABI json in *abi_paths* into the cache at *out*.
+    Modules are named after *names*, or the json file stems.
+
+    Cache keys cover the jitabi version & the python ABI of the interpreter
+    running the build, bundles have to be built with the same ones the
+    image runs.
+
+    '''
+    names = names or [p.stem for p in abi_paths]
+    if len(names) != len(abi_paths):
+        raise ValueError(
+            f'Got {len(names)} names for {len(abi_paths)} ABIs')
+
+    ctx = JITContext(cache_path=out, ipc_locked=False)
+    for name, path in zip(names, abi_paths):
+        abi = ABIView.from_file(path, cls=name)
+        key, _ = ctx.module_for_abi(
+            name, abi,
+            params=params,
+            force_reload=force_reload
+        )
+        logger.info(f'Built {key} into {ctx.module_dir_for(key)}')
+
+
+def _params_from_args(args: argparse.Namespace) -> ModuleParams:
+    return ModuleParams.from_dict({
+        'debug': args.debug,
+        'with_pack': not args.no_pack,
+        'with_unpack': not args.no_unpack,
+        'output': getattr(args, 'output', 'dict'),
+        'value_cache': args.value_cache,
+        'name_strings': args.name_strings,
+        'opt_level': args.opt_level,
+        'march_native': args.march_native,
+        'lto': args.lto,
+        'pgo': args.pgo,
+        'stats': args.stats,
+    })
+
+
+def _add_params_args(
+    parser: argparse.ArgumentParser,
+    *,
+    output: bool = True
+) -> None:
+    '''
+    Flags mirroring the `ModuleParams` fields.
+
+    '''
+    parser.add_argument('--debug', action='store_true')
+    parser.add_argument('--no-pack', action='store_true')
+    parser.add_argument('--no-unpack', action='store_true')
+    if output:
+        parser.add_argument('--output', choices=output_modes, default='dict')
+
+    parser.add_argument('--value-cache', action='store_true')
+    parser.add_argument('--name-strings', action='store_true')
+    parser.add_argument('--opt-level', type=int, choices=(0, 1, 2, 3))
+    parser.add_argument('--march-native', action='store_true')
+    parser.add_argument('--lto', action='store_true')
+    parser.add_argument('--pgo', choices=pgo_modes, default='off')
+    parser.add_argument('--stats', choices=stats_modes, default='off')
+
+
+def _cmd_build(args: argparse.Namespace) -> None:
+    build_bundle(
+        args.abis,
+        args.out,
+        _params_from_args(args),
+        names=args.name,
+        force_reload=args.force
+    )
+
+
+def _cmd_bench(args: argparse.Namespace) -> None:
+    if args.input and len(args.types) != 1:
+        raise SystemExit('--input payloads need a single --type')
+
+    abi = ABIView.from_file(args.abi, cls=args.name or args.abi.stem)
+    ctx = JITContext(cache_path=args.cache)
+
+    cases = bench.suite_cases(
+        ctx, args.name or args.abi.stem, abi, args.types,
+        modes=args.mode or bench.default_modes,
+        params=_params_from_args(args),
+        samples=args.samples,
+        payloads=(
+            {args.types[0]: bench.read_payloads(args.input)}
+            if args.input else None
+        ),
+        baseline=not args.no_baseline,
+        seed=args.seed
+    )
+    results = bench.run_cases(cases, min_time=args.min_time)
+
+    print(
+        bench.results_json(results) if args.json
+        else bench.format_results(results)
+    )
+
+
+def main(argv: list[str] | None = None) -> int:
+    parser = argparse.ArgumentParser(prog='jitabi')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    build = commands.add_parser(
+        'build',
+        help='compile modules ahead of time into a cache directory'
+    )
+    build.add_argument('abis', nargs='+', type=Path, help='ABI json files')
+    build.add_argument(
+        '--out', type=Path, required=True,
+        help='cache directory to build into'
+    )
+    build.add_argument(
+        '--name', action='append',
+        help='module name, once per ABI (default: json file stem)'
+    )
+    build.add_argument(
+        '--force', action='store_true',
+        help='regenerate & recompile even if cached'
+    )
+    _add_params_args(build)
+    build.set_defaults(func=_cmd_build)
+
+    bench_cmd = commands.add_parser(
+        'bench',
+        help='benchmark the module of an ABI'
+    )
+    bench_cmd.add_argument('abi', type=Path, help='ABI json file')
+    bench_cmd.add_argument(
+        '--type', action='append', required=True, dest='types',
+        help='type to benchmark, can be repeated'
+    )
+    bench_cmd.add_argument(
+        '--input', action='append', type=Path,
+        help=(
+            'captured payloads of --type, raw binary file or .hex file with '
+            'one payload per line, can be repeated (default: random values)'
+        )
+    )
+    bench_cmd.add_argument(
+        '--mode', action='append', choices=output_modes,
+        help='output mode, can be repeated (default: dict, tuple & lazy)'
+    )
+    bench_cmd.add_argument('--name', help='module name (default: json file stem)')
+    bench_cmd.add_argument(
+        '--cache', type=Path,
+        help='cache directory (default: ~/.jitabi)'
+    )
+    bench_cmd.add_argument(
+        '--samples', type=int, default=64,
+        help='random payloads per type'
+    )
+    bench_cmd.add_argument('--seed', type=int, default=0)
+    bench_cmd.add_argument(
+        '--min-time', type=float, default=0.2,
+        help='seconds spent timing each case'
+    )
+    bench_cmd.add_argument(
+        '--no-baseline', action='store_true',
+        help='skip the antelope_rs runs'
+    )
+    bench_cmd.add_argument(
+        '--json', action='store_true',
+        help='print results as json'
+    )
+    _add_params_args(bench_cmd, output=False)
+    bench_cmd.set_defaults(func=_cmd_bench)
+
+    args = parser.parse_args(argv)
+    logging.basicConfig(
+        level=logging.INFO if args.verbose else logging.WARNING)
+
+    args.func(args)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
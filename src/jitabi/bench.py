@@ -0,0 +1,350 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Benchmark harness behind `jitabi bench` and tests/test_bench.py.
+
+A :class:`Case` runs one codec entry point over a list of payloads of one
+type: direct `unpack_<type>` / `pack_<type>` functions, `unpack` / `pack`
+dynamic dispatch, `unpack_many` batches, and `antelope_rs` as baseline.
+Each output mode gets its own module. Every case reports:
+
+* ns/op: best time per payload over a few repeats, gc disabled
+* bytes/s: encoded bytes processed per second
+* allocs/op: memory blocks still held per payload after the call, what a
+  decoded value costs in objects (a packed payload counts one)
+
+'''
+from __future__ import annotations
+
+import gc
+import sys
+import json
+import time
+import random
+
+from typing import Any, Callable, Iterable
+from pathlib import Path
+from dataclasses import dataclass, asdict, replace
+
+from antelope_rs import ABIView
+
+from jitabi import random_payloads
+from jitabi.cache import ModuleParams
+
+
+# payload mixes of the system contracts, struct types of their actions and
+# tables
+MIXES: dict[str, list[str]] = {
+    'eosio_token': ['transfer', 'issue', 'account', 'currency_stats'],
+    'eosio_msig': ['propose', 'approve', 'proposal', 'approvals_info'],
+    'eosio_system': [
+        'delegatebw',
+        'buyrambytes',
+        'newaccount',
+        'regproducer',
+        'voter_info',
+        'producer_info',
+    ],
+}
+
+default_modes: tuple[str, ...] = ('dict', 'tuple', 'lazy')
+
+BASELINE = 'antelope_rs'
+
+
+@dataclass
+class Case:
+    '''
+    `fn(*args)` for every *args* of *calls*, covering *ops* payloads of
+    *nbytes* encoded bytes in total.
+
+    '''
+    name: str
+    mode: str
+    type_name: str
+    fn: Callable
+    calls: list[tuple]
+    ops: int
+    nbytes: int
+
+    def run(self) -> None:
+        fn = self.fn
+        for args in self.calls:
+            fn(*args)
+
+
+@dataclass
+class BenchResult:
+    name: str
+    mode: str
+    type_name: str
+    ns_per_op: float
+    bytes_per_s: float
+    allocs_per_op: float
+
+    def as_dict(self) -> dict:
+        return asdict(self)
+
+
+def _elapsed_ns(case: Case, rounds: int) -> int:
+    run = case.run
+    start = time.perf_counter_ns()
+    for _ in range(rounds):
+        run()
+
+    return time.perf_counter_ns() - start
+
+
+def _allocs_per_op(case: Case) -> float:
+    '''
+    Memory blocks the results of one round hold, per payload.
+
+    '''
+    fn = case.fn
+    kept: list[Any] = [None] * len(case.calls)
+
+    gc.collect()
+    before = sys.getallocatedblocks()
+    for i, args in enumerate(case.calls):
+        kept[i] = fn(*args)
+
+    after = sys.getallocatedblocks()
+    del kept
+    return max(after - before, 0) / case.ops
+
+
+def measure(
+    case: Case,
+    *,
+    min_time: float = 0.2,
+    repeat: int = 5
+) -> BenchResult:
+    '''
+    Time *case*, rounds are calibrated so each of the *repeat* timings takes
+    about *min_time* / *repeat* seconds, the best one is kept.
+
+    '''
+    target_ns = min_time * 1e9 / repeat
+
+    gc_was_enabled = gc.isenabled()
+    gc.disable()
+    try:
+        # warm up caches (dispatch, value cache, interned keys...)
+        case.run()
+
+        rounds = 1
+        while (elapsed := _elapsed_ns(case, rounds)) < target_ns:
+            rounds *= 2
+
+        best = elapsed
+        for _ in range(repeat - 1):
+            best = min(best, _elapsed_ns(case, rounds))
+
+    finally:
+        if gc_was_enabled:
+            gc.enable()
+
+    ns_per_op = best / (rounds * case.ops)
+    return BenchResult(
+        name=case.name,
+        mode=case.mode,
+        type_name=case.type_name,
+        ns_per_op=ns_per_op,
+        bytes_per_s=case.nbytes / case.ops / ns_per_op * 1e9,
+        allocs_per_op=_allocs_per_op(case)
+    )
+
+
+def read_payloads(paths: Iterable[Path]) -> list[bytes]:
+    '''
+    Captured payloads, `.hex` files hold one hex encoded payload per line,
+    any other file is a single raw payload.
+
+    '''
+    payloads: list[bytes] = []
+    for path in paths:
+        path = Path(path)
+        if path.suffix == '.hex':
+            payloads += [
+                bytes.fromhex(line)
+                for line in path.read_text().split()
+            ]
+
+        else:
+            payloads.append(path.read_bytes())
+
+    return payloads
+
+
+def module_cases(
+    module,
+    mode: str,
+    type_name: str,
+    payloads: list[bytes],
+    params: ModuleParams
+) -> list[Case]:
+    '''
+    Unpack & pack cases of *module* over *payloads*.
+
+    '''
+    nbytes = sum(len(p) for p in payloads)
+    ops = len(payloads)
+
+    def case(name: str, fn: Callable, calls: list[tuple]) -> Case:
+        return Case(name, mode, type_name, fn, calls, ops, nbytes)
+
+    cases: list[Case] = []
+    values: list[Any] = []
+    if params.with_unpack:
+        direct = getattr(module, f'unpack_{type_name}', None)
+        if direct is not None:
+            cases.append(case(
+                f'unpack_{type_name}', direct, [(p,) for p in payloads]))
+
+        cases.append(case(
+            'unpack', module.unpack, [(type_name, p) for p in payloads]))
+        cases.append(case(
+            'unpack_many', module.unpack_many, [(type_name, payloads)]))
+
+        values = [module.unpack(type_name, p) for p in payloads]
+
+    if params.with_pack and values:
+        direct = getattr(module, f'pack_{type_name}', None)
+        if direct is not None:
+            cases.append(case(
+                f'pack_{type_name}', direct, [(v,) for v in values]))
+
+        cases.append(case(
+            'pack', module.pack, [(type_name, v) for v in values]))
+
+    return cases
+
+
+def baseline_cases(
+    abi: ABIView,
+    type_name: str,
+    payloads: list[bytes]
+) -> list[Case]:
+    '''
+    The same payloads through `antelope_rs`.
+
+    '''
+    nbytes = sum(len(p) for p in payloads)
+    ops = len(payloads)
+    values = [abi.unpack(type_name, p) for p in payloads]
+    return [
+        Case(
+            'unpack', BASELINE, type_name, abi.unpack,
+            [(type_name, p) for p in payloads], ops, nbytes
+        ),
+        Case(
+            'pack', BASELINE, type_name, abi.pack,
+            [(type_name, v) for v in values], ops, nbytes
+        ),
+    ]
+
+
+def suite_cases(
+    ctx,
+    name: str,
+    abi: ABIView,
+    types: Iterable[str],
+    *,
+    modes: Iterable[str] = default_modes,
+    params: ModuleParams | dict | None = None,
+    samples: int = 64,
+    payloads: dict[str, list[bytes]] | None = None,
+    baseline: bool = True,
+    seed: int = 0
+) -> list[Case]:
+    '''
+    Cases for every type in *types* & output mode in *modes*, modules are
+    built through *ctx* with *params* and the mode as output. Payloads come
+    from *payloads* when given for a type, else *samples* random values.
+
+    '''
+    params = ModuleParams.from_dict(params or {})
+    payloads = payloads or {}
+    types = list(types)
+
+    type_payloads = {
+        t: payloads.get(t) or [
+            raw for _, raw in
+            random_payloads(abi, [t] * samples, rng=random.Random(seed))
+        ]
+        for t in types
+    }
+
+    cases: list[Case] = []
+    for mode in modes:
+        mode_params = replace(params, output=mode)
+        _, module = ctx.module_for_abi(name, abi, params=mode_params)
+        for t in types:
+            cases += module_cases(module, mode, t, type_payloads[t], mode_params)
+
+    if baseline:
+        for t in types:
+            cases += baseline_cases(abi, t, type_payloads[t])
+
+    return cases
+
+
+def run_cases(
+    cases: Iterable[Case],
+    *,
+    min_time: float = 0.2,
+    repeat: int = 5
+) -> list[BenchResult]:
+    return [
+        measure(case, min_time=min_time, repeat=repeat)
+        for case in cases
+    ]
+
+
+def format_results(results: list[BenchResult]) -> str:
+    '''
+    Text table of *results*, with the speedup over the baseline run of the
+    same type & direction when there's one.
+
+    '''
+    base = {
+        (r.type_name, r.name): r.ns_per_op
+        for r in results if r.mode == BASELINE
+    }
+
+    header = (
+        f'{"type":<20} {"mode":<12} {"case":<28} '
+        f'{"ns/op":>12} {"MB/s":>10} {"allocs/op":>10} {"vs rs":>7}'
+    )
+    lines = [header, '-' * len(header)]
+    for r in results:
+        kind = 'pack' if r.name.startswith('pack') else 'unpack'
+        ref = base.get((r.type_name, kind))
+        speedup = (
+            f'{ref / r.ns_per_op:6.2f}x'
+            if ref and r.mode != BASELINE else ''
+        )
+        lines.append(
+            f'{r.type_name:<20} {r.mode:<12} {r.name:<28} '
+            f'{r.ns_per_op:>12.1f} {r.bytes_per_s / 1e6:>10.1f} '
+            f'{r.allocs_per_op:>10.1f} {speedup:>7}'
+        )
+
+    return '\n'.join(lines)
+
+
+def results_json(results: list[BenchResult]) -> str:
+    return json.dumps([r.as_dict() for r in results], indent=4)
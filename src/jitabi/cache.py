@@ -24,7 +24,12 @@ artifacts:
 
 The :class:`Cache` class keeps an in‑memory mirror of those artifacts to avoid
 hitting the filesystem more than necessary, but it always persists updates to
-disk so that subsequent interpreter sessions can reuse them.
+disk so that subsequent interpreter sessions can reuse them. On startup only
+the `params.json` of each entry is read, sources & modules are loaded the
+first time their key is requested.
+
+The shared runtime module generated modules link against at import lives
+apart, under `<cache_root>/.runtime/` (see :mod:`jitabi.runtime`).
 
 '''
 from __future__ import annotations
@@ -47,7 +52,8 @@ from importlib.machinery import ExtensionFileLoader
 
 from jitabi.utils import (
     fd_lock,
-    fd_unlock
+    fd_unlock,
+    host_cpu_id
 )
 
 
@@ -89,6 +95,41 @@ def import_module(
 default_param_debug: bool = False
 default_param_with_pack: bool = True
 default_param_with_unpack: bool = True
+default_param_output: str = 'dict'
+default_param_value_cache: bool = False
+default_param_name_strings: bool = False
+default_param_opt_level: int | None = None
+default_param_march_native: bool = False
+default_param_lto: bool = False
+default_param_pgo: str = 'off'
+default_param_stats: str = 'off'
+
+# how decoded structs are represented:
+#
+#   - `dict`: one dict per struct instance keyed by field name
+#   - `tuple`: plain tuples, fields in declaration order (base fields first)
+#   - `structseq`: one `PyStructSequence` type per struct, named tuples
+#     also reachable through the module's `structs` mapping
+#   - `lazy`: `LazyStruct` views over the input bytes, fields decoded on
+#     first access
+output_modes: tuple[str, ...] = ('dict', 'tuple', 'structseq', 'lazy')
+
+# build profile knobs, modules are compiled on the host that runs them so
+# they can be tuned for it:
+#
+#   - `opt_level`: `-O<n>` (`/O<n>` on msvc), `None` keeps Python's CFLAGS
+#   - `march_native`: target the host cpu, cache key also covers the cpu
+#   - `lto`: link time optimization
+#   - `pgo`: `generate` builds an instrumented module, `use` rebuilds it
+#     with the profile it collected
+opt_levels: tuple[int | None, ...] = (None, 0, 1, 2, 3)
+pgo_modes: tuple[str, ...] = ('off', 'generate', 'use')
+
+# per type hot path counters exported through the module's `stats()`:
+#
+#   - `counters`: calls, bytes, objects & errors
+#   - `timing`: counters plus cycle (or clock tick) totals
+stats_modes: tuple[str, ...] = ('off', 'counters', 'timing')
 
 
 @dataclass(frozen=True)
@@ -96,35 +137,120 @@ class ModuleParams:
     debug: bool
     with_pack: bool
     with_unpack: bool
+    output: str = default_param_output
+    value_cache: bool = default_param_value_cache
+    name_strings: bool = default_param_name_strings
+    opt_level: int | None = default_param_opt_level
+    march_native: bool = default_param_march_native
+    lto: bool = default_param_lto
+    pgo: str = default_param_pgo
+    stats: str = default_param_stats
+
+    def __post_init__(self):
+        if self.output not in output_modes:
+            raise ValueError(
+                f'Unknown output mode {self.output!r}, expected one of {output_modes}'
+            )
+
+        if self.opt_level not in opt_levels:
+            raise ValueError(
+                f'Unknown opt level {self.opt_level!r}, expected one of {opt_levels}'
+            )
+
+        if self.pgo not in pgo_modes:
+            raise ValueError(
+                f'Unknown pgo mode {self.pgo!r}, expected one of {pgo_modes}'
+            )
+
+        if self.stats not in stats_modes:
+            raise ValueError(
+                f'Unknown stats mode {self.stats!r}, expected one of {stats_modes}'
+            )
 
     def as_dict(self) -> dict:
         return {
             'debug': self.debug,
             'with_pack': self.with_pack,
-            'with_unpack': self.with_unpack
+            'with_unpack': self.with_unpack,
+            'output': self.output,
+            'value_cache': self.value_cache,
+            'name_strings': self.name_strings,
+            'opt_level': self.opt_level,
+            'march_native': self.march_native,
+            'lto': self.lto,
+            'pgo': self.pgo,
+            'stats': self.stats
         }
 
     def as_bytes(self) -> bytes:
-        return bytes([
+        raw = bytes([
             int(self.debug),
             int(self.with_pack),
-            int(self.with_unpack)
-        ])
+            int(self.with_unpack),
+            int(self.value_cache),
+            int(self.name_strings)
+        ]) + self.output.encode()
+
+        # only append build profile & stats bytes when set, keeps the keys of
+        # modules built before they existed valid
+        if not self.is_default_profile():
+            raw += bytes([
+                0xff if self.opt_level is None else self.opt_level,
+                int(self.march_native),
+                int(self.lto),
+                pgo_modes.index(self.pgo)
+            ])
+
+            # a -march=native build is only valid on the cpu it was built for
+            if self.march_native:
+                raw += host_cpu_id().encode()
+
+        if self.stats != default_param_stats:
+            raw += b'stats=' + self.stats.encode()
+
+        return raw
+
+    def is_default_profile(self) -> bool:
+        return (
+            self.opt_level == default_param_opt_level and
+            self.march_native == default_param_march_native and
+            self.lto == default_param_lto and
+            self.pgo == default_param_pgo
+        )
 
     @staticmethod
-    def from_dict(d: dict) -> ModuleParams:
+    def from_dict(d: dict | ModuleParams) -> ModuleParams:
+        if isinstance(d, ModuleParams):
+            return d
+
         return ModuleParams(
             debug=d.get('debug', default_param_debug),
             with_pack=d.get('with_pack', default_param_with_pack),
             with_unpack=d.get('with_unpack', default_param_with_unpack),
+            output=d.get('output', default_param_output),
+            value_cache=d.get('value_cache', default_param_value_cache),
+            name_strings=d.get('name_strings', default_param_name_strings),
+            opt_level=d.get('opt_level', default_param_opt_level),
+            march_native=d.get('march_native', default_param_march_native),
+            lto=d.get('lto', default_param_lto),
+            pgo=d.get('pgo', default_param_pgo),
+            stats=d.get('stats', default_param_stats),
         )
 
     @staticmethod
     def default() -> ModuleParams:
         return ModuleParams(
             debug=default_param_debug,
-    with_pack=default_param_with_pack,
-            with_unpack=default_param_with_unpack
+            with_pack=default_param_with_pack,
+            with_unpack=default_param_with_unpack,
+            output=default_param_output,
+            value_cache=default_param_value_cache,
+            name_strings=default_param_name_strings,
+            opt_level=default_param_opt_level,
+            march_native=default_param_march_native,
+            lto=default_param_lto,
+            pgo=default_param_pgo,
+            stats=default_param_stats
         )
 
 
@@ -134,13 +260,25 @@ class CacheKey:
     src_hash: str
     params: ModuleParams
 
+    @property
+    def base_name(self) -> str:
+        '''
+        *mod_name* without the `_<version>` suffix `JITContext` appends, shared
+        by every version of the module.
+
+        '''
+        name, _, version = self.mod_name.rpartition('_')
+        return name if name and version.isdigit() else self.mod_name
+
     def __str__(self) -> str:
         s = f'{self.mod_name} (hash {self.src_hash}'
 
         if (
             self.params.debug or
             self.params.with_pack or
-            self.params.with_unpack
+            self.params.with_unpack or
+            self.params.value_cache or
+            self.params.name_strings
         ):
             s += ', with flags:'
 
@@ -153,6 +291,33 @@ class CacheKey:
             if self.params.with_unpack:
                 s += ' with_unpack'
 
+            if self.params.value_cache:
+                s += ' value_cache'
+
+            if self.params.name_strings:
+                s += ' name_strings'
+
+        if self.params.output != default_param_output:
+            s += f', output: {self.params.output}'
+
+        if not self.params.is_default_profile():
+            s += ', profile:'
+
+            if self.params.opt_level is not None:
+                s += f' O{self.params.opt_level}'
+
+            if self.params.march_native:
+                s += ' march_native'
+
+            if self.params.lto:
+                s += ' lto'
+
+            if self.params.pgo != default_param_pgo:
+                s += f' pgo={self.params.pgo}'
+
+        if self.params.stats != default_param_stats:
+            s += f', stats: {self.params.stats}'
+
         s += ')'
 
         return s
@@ -160,7 +325,8 @@ class CacheKey:
 
 @dataclass
 class CacheEntry:
-    source: str
+    # both loaded on first request, see `Cache._warm_from_disk`
+    source: str | None
     module: ModuleType | None
 
     @staticmethod
@@ -173,6 +339,8 @@ class CacheEntry:
 
 class Cache:
     _cache: dict[CacheKey, CacheEntry]
+    # keys by `CacheKey.base_name`, see `keys_for`
+    _by_name: dict[str, list[CacheKey]]
 
     def __init__(
         self,
@@ -199,6 +367,7 @@ class Cache:
         logger.info(f'Using cache directory {self.fs_location}')
 
         self._cache = {}
+        self._by_name = {}
         self._warm_from_disk()
 
     @cm
@@ -239,11 +408,16 @@ class Cache:
 
     def _warm_from_disk(self) -> None:
         '''
-        Populate the in‑memory map with artifacts already on disk.
+        Index the artifacts already on disk by their `params.json`.
+
+        Sources and compiled modules are left on disk, `get_abi_source` &
+        `get_module` load them on first request for their key. Startup cost
+        doesn't grow with the number of stale entries in the cache.
 
         '''
         for mod_dir in self.fs_location.iterdir():
-            if not mod_dir.is_dir():
+            # dot dirs aren't modules (`.runtime`)
+            if not mod_dir.is_dir() or mod_dir.name.startswith('.'):
                 continue
 
             mod_name = mod_dir.name
@@ -251,74 +425,86 @@ class Cache:
                 if not src_hash_dir.is_dir():
                     continue
 
-                with self.dir_lock(src_hash_dir):
-                    src_hash = src_hash_dir.name
+                src_hash = src_hash_dir.name
 
-                    # load params
-                    params_path = src_hash_dir / 'params.json'
-                    if not params_path.is_file():
-                        logger.warning(
-                            f'Could not load params file for {mod_name} (hash {src_hash}),'
-                            ' skipping module cache...'
-                        )
-                        continue
+                # load params
+                params_path = src_hash_dir / 'params.json'
+                if not params_path.is_file():
+                    logger.warning(
+                        f'Could not load params file for {mod_name} (hash {src_hash}),'
+                        ' skipping module cache...'
+                    )
+                    continue
 
+                with self.dir_lock(src_hash_dir, shared=True):
                     params = json.loads(params_path.read_text())
 
-                    if (
-                        'debug' not in params
-                        or
-                        'with_pack' not in params
-                        or
-                        'with_unpack' not in params
-                    ):
-                        logger.warning(
-                            f'Malformed params file for {mod_name} (hash {src_hash}), '
-                            ' skipping module cache...'
-                        )
-                        continue
-
-                    key: CacheKey = CacheKey(
-                        mod_name=mod_name,
-                        src_hash=src_hash,
-                        params=ModuleParams(**params)
+                if (
+                    'debug' not in params
+                    or
+                    'with_pack' not in params
+                    or
+                    'with_unpack' not in params
+                ):
+                    logger.warning(
+                        f'Malformed params file for {mod_name} (hash {src_hash}), '
+                        ' skipping module cache...'
+                    )
+                    continue
+
+                try:
+                    key_params = ModuleParams.from_dict(params)
+
+                except ValueError:
+                    logger.warning(
+                        f'Invalid params file for {mod_name} (hash {src_hash}), '
+                        ' skipping module cache...'
                     )
-                    module: ModuleType | None = None
-
-                    # load C source if present
-                    src_path = src_hash_dir / f'{mod_name}.c'
-                    if src_path.is_file():
-                        source = src_path.read_text()
-                        logger.debug(
-                            f'Loaded source for {str(key)})'
-                        )
-
-                    else:
-                        logger.warning(
-                            f'Source not found for {key}, skipping load...'
-                        )
-                        continue
-
-                    # load compiled module if present
-                    mod_path = src_hash_dir / f'{mod_name}{EXT_SUFFIX}'
-                    if mod_path.is_file():
-                        try:
-                            module = import_module(mod_name, mod_path)
-                            logger.debug(
-                                f'Loaded compiled module for {str(key)})'
-                            )
-
-                        except Exception:
-                            logger.exception(
-                                f'Failed to import cached module {str(key)})'
-                            )
-                            continue
-
-                self._cache[key] = CacheEntry(
-                    source=source,
-                    module=module
+                    continue
+
+                key: CacheKey = CacheKey(
+                    mod_name=mod_name,
+                    src_hash=src_hash,
+                    params=key_params
                 )
 
+                # prebuilt bundles may ship without the C source
+                if (
+                    not (src_hash_dir / f'{mod_name}.c').is_file()
+                    and
+                    not (src_hash_dir / f'{mod_name}{EXT_SUFFIX}').is_file()
+                ):
+                    logger.warning(
+                        f'No source or compiled module for {key}, skipping load...'
+                    )
+                    continue
+
+                logger.debug(f'Indexed {str(key)}')
+                self._entry_for(key)
+
+    def _entry_for(self, key: CacheKey) -> CacheEntry:
+        '''
+        Return *key*'s entry, adding an empty one if it's not indexed yet.
+
+        '''
+        entry = self._cache.get(key, None)
+        if entry is None:
+            entry = self._cache[key] = CacheEntry(source=None, module=None)
+            self._by_name.setdefault(key.base_name, []).append(key)
+
+        return entry
+
+    def keys_for(self, key: CacheKey) -> list[CacheKey]:
+        '''
+        Keys of every indexed module sharing *key*'s base name & params, one
+        per ABI version seen, whatever version suffix they were built under.
+
+        '''
+        return [
+            other for other in self._by_name.get(key.base_name, [])
+            if other.params == key.params
+        ]
+
     def get_module_path(self, key: CacheKey) -> Path:
         '''
         Return the directory where *key*'s artifacts are stored.
@@ -335,9 +521,10 @@ class Cache:
         Return cached source for *key* or *None* if missing.
 
         '''
-        if not force_reload and key in self._cache:
+        entry = self._cache.get(key, None)
+        if not force_reload and entry and entry.source is not None:
             logger.debug(f'Returning in‑memory source for {key}')
-            return self._cache[key].source
+            return entry.source
 
         module_path = self.get_module_path(key)
 
@@ -346,7 +533,7 @@ class Cache:
             if src_path.is_file():
                 logger.debug(f'Reading C source for {key} from {src_path}')
                 source = src_path.read_text()
-                self._cache.setdefault(key, CacheEntry.from_source(source)).source = source
+                self._entry_for(key).source = source
 
                 return source
 
@@ -367,7 +554,7 @@ class Cache:
             )
 
         logger.debug(f'Storing sources for {key}')
-        self._cache.setdefault(key, CacheEntry.from_source(source)).source = source
+        self._entry_for(key).source = source
 
         src_dir = self.get_module_path(key)
         src_dir.mkdir(parents=True, exist_ok=True)
@@ -407,5 +594,5 @@ class Cache:
                 logger.exception(f'Failed to import module {mod_path}')
                 return None
 
-            self._cache.setdefault(key, CacheEntry.from_source(entry.source)).module = module
+            self._entry_for(key).module = module
             return module
@@ -20,6 +20,9 @@ Code generation and compilation routines for ABI C modules.
 import json
 import logging
 
+from types import SimpleNamespace
+
+from jitabi.cache import ModuleParams
 from jitabi.sanitize import (
     check_type,
     check_ident
@@ -32,6 +35,9 @@ from jitabi.templates import (
     pack_enum_tmpl,
     unpack_struct_tmpl,
     pack_struct_tmpl,
+    skip_alias_tmpl,
+    skip_enum_tmpl,
+    skip_struct_tmpl,
 )
 
 from antelope_rs import (
@@ -53,10 +59,488 @@ _bytes_types: set[str] = {
     'signature'
 }
 
+# std types with both unpack_<name> & pack_<name> defined on
+# templates/unpack_std.c & templates/pack_std.c
+_std_types: list[str] = [
+    'bool',
+
+    'uint8',
+    'uint16',
+    'uint32',
+    'uint64',
+    'uint128',
+
+    'int8',
+    'int16',
+    'int32',
+    'int64',
+    'int128',
+
+    'varuint32',
+    'varint32',
+
+    'float32',
+    'float64',
+    'float128',
+
+    'bytes',
+    'string',
+
+    'name',
+    'account_name',
+    'symbol',
+    'symbol_code',
+    'asset',
+    'extended_asset',
+
+    'checksum160',
+    'checksum256',
+    'checksum512',
+
+    'time_point',
+    'time_point_sec',
+    'block_timestamp_type',
+
+    'public_key',
+    'signature',
+]
+
+# std structs, rendered with the same templates as ABI structs so they follow
+# the module output mode, fields are (name, std type) pairs
+_std_structs: dict[str, list[tuple[str, str]]] = {
+    'asset': [
+        ('amount', 'int64'),
+        ('symbol', 'symbol'),
+    ],
+    'extended_asset': [
+        ('quantity', 'asset'),
+        ('contract', 'name'),
+    ],
+}
+
+# encoded size of the fixed width std types, must match the DEF_SKIP_FIXED
+# definitions on templates/unpack_std.c
+_std_fixed_sizes: dict[str, int] = {
+    'bool': 1,
+
+    'uint8': 1,
+    'uint16': 2,
+    'uint32': 4,
+    'uint64': 8,
+    'uint128': 16,
+
+    'int8': 1,
+    'int16': 2,
+    'int32': 4,
+    'int64': 8,
+    'int128': 16,
+
+    'float32': 4,
+    'float64': 8,
+    'float128': 16,
+
+    'name': 8,
+    'account_name': 8,
+    'symbol': 8,
+    'symbol_code': 8,
+
+    'checksum160': 20,
+    'checksum256': 32,
+    'checksum512': 64,
+
+    'time_point': 8,
+    'time_point_sec': 4,
+    'block_timestamp_type': 4,
+
+    'public_key': 34,
+    'signature': 66,
+}
+
+# dict keys not coming from an ABI struct field or enum variant name
+_std_keys: list[str] = [
+    'type',
+]
+
+# extra dispatch names kept for backwards compatibility
+_std_dispatch_aliases: dict[str, str] = {
+    'str': 'string'
+}
+
+
+def _fnv1a(name: str) -> int:
+    '''
+    32 bit FNV-1a hash of *name*, must match `hash_type_name` on
+    templates/module.c.j2.
+
+    '''
+    h = 0x811c9dc5
+    for b in name.encode('utf-8'):
+        h ^= b
+        h = (h * 0x01000193) & 0xffffffff
+
+    return h
+
+
+def build_dispatch_table(
+    names: dict[str, str],
+    fixed_sizes: dict[str, int] = {}
+) -> dict:
+    '''
+    Given a mapping of dispatch name -> C function suffix, layout an open
+    addressing hash table (linear probing, load factor <= 0.5) to be emitted
+    as static data on the generated module.
+
+    Returns a dict with:
+
+        - `types`: list of entries `{name, fn, hash, size}`, order matches
+          indexes, `size` is the encoded size of fixed size types, 0 otherwise
+        - `slots`: list of ints, 0 means empty slot, otherwise index + 1
+        - `index`: dispatch name -> index into `types`
+
+    '''
+    types = [
+        {
+            'name': name,
+            'fn': fn,
+            'hash': _fnv1a(name),
+            'size': fixed_sizes.get(fn, 0)
+        }
+        for name, fn in sorted(names.items())
+    ]
+
+    size = 1
+    while size < len(types) * 2:
+        size <<= 1
+
+    slots = [0] * size
+    for i, t in enumerate(types):
+        slot = t['hash'] & (size - 1)
+        while slots[slot]:
+            slot = (slot + 1) & (size - 1)
+
+        slots[slot] = i + 1
+
+    return {
+        'types': types,
+        'slots': slots,
+        'index': {t['name']: i for i, t in enumerate(types)}
+    }
+
+
+def _std_call(type_name: str) -> SimpleNamespace:
+    '''
+    Resolved type call for a std type without modifiers, same shape as the
+    ones returned by `ABIView.resolve_type`.
+
+    '''
+    return SimpleNamespace(
+        original_name=type_name,
+        resolved_name=type_name,
+        modifiers=[]
+    )
+
+
+def _flat_fields(
+    sname: str,
+    structs: dict[str, dict],
+    seen: tuple[str, ...] = ()
+) -> list[dict]:
+    '''
+    Fields of struct *sname* including the ones inherited from its base chain,
+    base fields first, as laid out on the wire.
+
+    '''
+    if sname in seen:
+        raise TypeError(f'struct {sname} has a circular base chain')
+
+    struct = structs[sname]
+    bname = struct['base']
+    if not bname:
+        return list(struct['fields'])
+
+    if bname not in structs:
+        raise TypeError(f'struct {sname} base {bname} is not a struct')
+
+    return _flat_fields(bname, structs, seen + (sname,)) + struct['fields']
+
+
+def _fixed_size(
+    type_name: str,
+    structs: dict[str, dict],
+    sizes: dict[str, int | None],
+    stack: tuple[str, ...] = ()
+) -> int | None:
+    '''
+    Encoded size of *type_name* when every value of it has the same one (fixed
+    width std types & structs made only of those), None otherwise. Struct
+    results are memoized on *sizes*.
+
+    '''
+    if type_name in _std_fixed_sizes:
+        return _std_fixed_sizes[type_name]
+
+    if type_name not in structs or type_name in stack:
+        return None
+
+    if type_name in sizes:
+        return sizes[type_name]
+
+    stack += (type_name,)
+    struct = structs[type_name]
+
+    size = 0
+    bname = struct['base']
+    if bname:
+        size = _fixed_size(bname, structs, sizes, stack)
+
+    for f in struct['fields']:
+        if size is None:
+            break
+
+        call = f['call']
+        fsize = (
+            None if call.modifiers
+            else _fixed_size(call.resolved_name, structs, sizes, stack)
+        )
+        size = None if fsize is None else size + fsize
+
+    sizes[type_name] = size
+    return size
+
+
+def _field_offsets(fields: list[dict], fixed_sizes: dict[str, int]) -> list[int]:
+    '''
+    Wire offset of each of the fixed size *fields*, relative to the first.
+
+    '''
+    offsets = []
+    offset = 0
+    for f in fields:
+        offsets.append(offset)
+        offset += fixed_sizes[f['call'].resolved_name]
+
+    return offsets
+
+
+def _render_struct(
+    sname: str,
+    structs: dict[str, dict],
+    output: str,
+    fixed_sizes: dict[str, int]
+) -> dict:
+    '''
+    Render unpack, pack & skip code for struct *sname*, dict mode unpack and
+    pack delegate base fields to the base struct functions while the other
+    modes inline the whole flattened field list. Skip code always walks the
+    flattened list (when the base chain can be flattened) so recorded field
+    offsets index it.
+
+    Fixed size structs unpack & pack through straight line code, one bounds
+    check for the whole struct and every field at a constant offset.
+
+    '''
+    struct = structs[sname]
+    base = struct['base']
+    fields = struct['fields']
+
+    try:
+        flat_fields = _flat_fields(sname, structs)
+
+    except TypeError:
+        if output != 'dict':
+            raise
+
+        # non struct base, skip through its function
+        flat_fields = None
+
+    if output != 'dict':
+        base = None
+        fields = flat_fields
+
+        names = [f['name'] for f in fields]
+        if output == 'structseq' and len(set(names)) != len(names):
+            raise TypeError(
+                f'struct {sname} redefines an inherited field, can\'t be a structseq'
+            )
+
+    # fixed size structs skip in constant time, field offsets are known too
+    size = fixed_sizes.get(sname)
+    offsets = None
+    layout = None
+    if size is not None and flat_fields is not None:
+        offsets = _field_offsets(flat_fields, fixed_sizes)
+
+        # unpack & pack check bounds once and go straight to each field,
+        # dict mode own fields start after the base ones
+        start = fixed_sizes[base] if base else 0
+        layout = [start + o for o in _field_offsets(fields, fixed_sizes)]
+
+    tmpl_args = {
+        'fn_name': sname,
+        'base': base,
+        'fields': fields,
+        'output': output,
+        'fixed_sizes': fixed_sizes,
+        'size': size,
+        'layout': layout
+    }
+
+    skip_args = dict(tmpl_args)
+    if flat_fields is not None:
+        skip_args.update(base=None, fields=flat_fields)
+
+    return {
+        'name': sname,
+        'fields': fields,
+        'flat_fields': flat_fields,
+        'size': size,
+        'unpack_code': unpack_struct_tmpl.render(**tmpl_args),
+        'pack_code': pack_struct_tmpl.render(**tmpl_args),
+        'skip_code': skip_struct_tmpl.render(
+            **skip_args,
+            offsets=offsets
+        )
+    }
+
+
+# modifier chains a projection path can step through
+_proj_kinds: dict[tuple[str, ...], str] = {
+    (): 'JITABI_PROJ_PLAIN',
+    ('optional',): 'JITABI_PROJ_OPTIONAL',
+    ('extension',): 'JITABI_PROJ_EXTENSION',
+}
+
+
+# std types with a typed column in `unpack_columns`:
+# (kind, buffer format, item size)
+_column_formats: dict[str, tuple[str, str, int]] = {
+    'bool': ('JITABI_COL_FIXED', '?', 1),
+
+    'uint8': ('JITABI_COL_FIXED', 'B', 1),
+    'uint16': ('JITABI_COL_FIXED', 'H', 2),
+    'uint32': ('JITABI_COL_FIXED', 'I', 4),
+    'uint64': ('JITABI_COL_FIXED', 'Q', 8),
+
+    'int8': ('JITABI_COL_FIXED', 'b', 1),
+    'int16': ('JITABI_COL_FIXED', 'h', 2),
+    'int32': ('JITABI_COL_FIXED', 'i', 4),
+    'int64': ('JITABI_COL_FIXED', 'q', 8),
+
+    'float32': ('JITABI_COL_FIXED', 'f', 4),
+    'float64': ('JITABI_COL_FIXED', 'd', 8),
+
+    'name': ('JITABI_COL_FIXED', 'Q', 8),
+    'account_name': ('JITABI_COL_FIXED', 'Q', 8),
+    'symbol': ('JITABI_COL_FIXED', 'Q', 8),
+    'symbol_code': ('JITABI_COL_FIXED', 'Q', 8),
+
+    'time_point': ('JITABI_COL_FIXED', 'Q', 8),
+    'time_point_sec': ('JITABI_COL_FIXED', 'I', 4),
+    'block_timestamp_type': ('JITABI_COL_FIXED', 'I', 4),
+
+    'varuint32': ('JITABI_COL_VARUINT32', 'I', 4),
+    'varint32': ('JITABI_COL_VARINT32', 'i', 4),
+
+    'string': ('JITABI_COL_BYTES', 'B', 1),
+    'bytes': ('JITABI_COL_BYTES', 'B', 1),
+}
+
+
+def _column_of(call) -> tuple[str, str, int]:
+    '''
+    (kind, buffer format, item size) of the `unpack_columns` column a field
+    decodes into, everything without a typed column becomes a list.
+
+    '''
+    if not call.modifiers:
+        name = call.resolved_name
+        if name in _column_formats:
+            return _column_formats[name]
+
+        # remaining fixed width std types: rows of raw bytes
+        if name in _std_fixed_sizes:
+            return 'JITABI_COL_FIXED', 'B', _std_fixed_sizes[name]
+
+    return 'JITABI_COL_OBJECT', '', 0
+
+
+def _projection_types(
+    structs: list[dict],
+    enums: dict[str, list[dict]],
+    aliases: dict[str, SimpleNamespace]
+) -> dict:
+    '''
+    Layout the metadata field projections resolve paths against: one entry
+    per struct (flattened fields) and enum (variants), each field pointing to
+    the entry it can be stepped into or -1 for leaves. `names` maps every
+    struct, enum & plain alias name to its entry.
+
+    '''
+    index: dict[str, int] = {}
+    for s in structs:
+        if s['flat_fields'] is not None:
+            index[s['name']] = len(index)
+
+    for ename in enums:
+        index[ename] = len(index)
+
+    def step(call) -> tuple[int, str]:
+        kind = _proj_kinds.get(tuple(call.modifiers))
+        if kind is None or call.resolved_name not in index:
+            return -1, 'JITABI_PROJ_PLAIN'
+
+        return index[call.resolved_name], kind
+
+    types = []
+    for s in structs:
+        if s['flat_fields'] is None:
+            continue
+
+        fields = []
+        for f in s['flat_fields']:
+            target, kind = step(f['call'])
+            fields.append({
+                'name': f['name'],
+                'type_name': f['call'].original_name,
+                'type': target,
+                'kind': kind,
+                'column': _column_of(f['call'])
+            })
+
+        types.append({'name': s['name'], 'is_enum': False, 'fields': fields})
+
+    for ename, variants in enums.items():
+        fields = []
+        for v in variants:
+            target, kind = step(v['call'])
+            fields.append({
+                'name': v['name'],
+                'type_name': v['name'],
+                'type': target if kind == 'JITABI_PROJ_PLAIN' else -1,
+                'kind': 'JITABI_PROJ_PLAIN',
+                'column': ('JITABI_COL_OBJECT', '', 0)
+            })
+
+        types.append({'name': ename, 'is_enum': True, 'fields': fields})
+
+    names = dict(index)
+    for alias, call in aliases.items():
+        if not call.modifiers and call.resolved_name in index:
+            names.setdefault(alias, index[call.resolved_name])
+
+    return {
+        'types': types,
+        'names': sorted(names.items()),
+        'max_fields': max(
+            [len(t['fields']) for t in types if not t['is_enum']] + [1]
+        )
+    }
+
 
 def try_c_source_from_abi(
     name: str,
-    abi: ABIView
+    abi: ABIView,
+    params: ModuleParams | None = None
 ) -> str:
     '''
     Given a module name and an object implementing the ABIView protocol,
@@ -64,11 +548,29 @@ def try_c_source_from_abi(
     defined by the ABIView, return it as a string.
 
     '''
+    params = params or ModuleParams.default()
+    output = params.output
+
     # check module name is valid (prevents injections)
     check_ident(name, what='module name')
 
     functions: list[dict] = []
 
+    # every struct field & enum variant name, emitted as interned keys
+    dict_keys: set[str] = set(_std_keys)
+
+    std_structs: dict[str, dict] = {
+        sname: {
+            'base': None,
+            'fields': [
+                {'name': fname, 'call': _std_call(ftype)}
+                for fname, ftype in fields
+            ]
+        }
+        for sname, fields in _std_structs.items()
+    }
+
+    structs: dict[str, dict] = {}
     for struct_meta in abi.structs:
         sname = struct_meta.name
         check_ident(sname, f'struct {sname}')
@@ -87,19 +589,32 @@ def try_c_source_from_abi(
                 'call': abi.resolve_type(f.type_)
             })
 
-        functions.append({
-            'name': sname,
-            'unpack_code': unpack_struct_tmpl.render(
-                fn_name=sname,
-                base=bname,
-                fields=fields
-            ),
-            'pack_code': pack_struct_tmpl.render(
-                fn_name=sname,
-                base=bname,
-                fields=fields
-            )
-        })
+        structs[sname] = {
+            'base': bname,
+            'fields': fields
+        }
+
+    all_structs = {**std_structs, **structs}
+    for struct in all_structs.values():
+        dict_keys.update(f['name'] for f in struct['fields'])
+
+    sizes: dict[str, int | None] = {}
+    fixed_sizes: dict[str, int] = dict(_std_fixed_sizes)
+    for sname in all_structs:
+        size = _fixed_size(sname, all_structs, sizes)
+        if size is not None:
+            fixed_sizes[sname] = size
+
+    std_functions: list[dict] = [
+        _render_struct(sname, all_structs, output, fixed_sizes)
+        for sname in std_structs
+    ]
+
+    struct_functions: list[dict] = [
+        _render_struct(sname, all_structs, output, fixed_sizes)
+        for sname in structs
+    ]
+    functions += struct_functions
 
     alias_defs = {}
     for a in abi.types:
@@ -127,11 +642,16 @@ def try_c_source_from_abi(
             'pack_code': pack_alias_tmpl.render(
                 alias=new_type_name,
                 call=abi.resolve_type(from_type_name)
+            ),
+            'skip_code': skip_alias_tmpl.render(
+                alias=new_type_name,
+                call=abi.resolve_type(from_type_name)
             )
         }
         for new_type_name, from_type_name in alias_defs.items()
     ]
 
+    enums: dict[str, list[dict]] = {}
     for var_meta in abi.variants:
         ename = var_meta.name
         check_ident(ename, f'enum {ename}')
@@ -172,17 +692,26 @@ def try_c_source_from_abi(
                 'call': var_call,
                 'is_std': is_std
             })
+            if not is_std:
+                dict_keys.add(variant)
 
+        enums[ename] = variants
         functions.append({
             'name': ename,
             'unpack_code': unpack_enum_tmpl.render(
                 enum_name=ename,
-                variants=variants
+                variants=variants,
+                output=output
             ),
             'pack_code': pack_enum_tmpl.render(
                 enum_name=ename,
                 input_types=list(targets.keys()),
                 targets=targets,
+                variants=variants,
+                output=output
+            ),
+            'skip_code': skip_enum_tmpl.render(
+                enum_name=ename,
                 variants=variants
             )
         })
@@ -190,11 +719,31 @@ def try_c_source_from_abi(
     logger.debug(f'Function names: {json.dumps([f["name"] for f in functions], indent=4)}')
     logger.debug(f'Aliases: {json.dumps(alias_defs, indent=4)}')
 
+    dispatch_names: dict[str, str] = {
+        name: name for name in _std_types
+    }
+    dispatch_names.update(_std_dispatch_aliases)
+    dispatch_names.update({f['name']: f['name'] for f in functions})
+    dispatch_names.update({a['alias']: a['alias'] for a in aliases})
+
     source = module_tmpl.render(
         m_name=name,
         m_doc=name,
+        output=output,
         aliases=aliases,
-        functions=functions
+        std_functions=std_functions,
+        functions=functions,
+        structs=std_functions + struct_functions,
+        projection=_projection_types(
+            std_functions + struct_functions,
+            enums,
+            {
+                alias: abi.resolve_type(from_type_name)
+                for alias, from_type_name in alias_defs.items()
+            }
+        ),
+        keys=sorted(dict_keys),
+        dispatch=build_dispatch_table(dispatch_names, fixed_sizes)
     )
 
     return source
@@ -202,10 +751,11 @@ def try_c_source_from_abi(
 
 def c_source_from_abi(
     name: str,
-    abi: ABIView
+    abi: ABIView,
+    params: ModuleParams | None = None
 ) -> str:
     try:
-        return try_c_source_from_abi(name, abi)
+        return try_c_source_from_abi(name, abi, params=params)
 
     except Exception as e:
         logger.error(
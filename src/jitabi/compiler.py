@@ -21,7 +21,10 @@ import sys as py_sys
 import time
 import json
 import logging
+import platform
+import subprocess
 
+from shutil import which
 from pathlib import Path
 from setuptools._distutils import (
     ccompiler,
@@ -35,12 +38,109 @@ from jitabi.utils import detect_compiler_type
 logger = logging.getLogger(__name__)
 
 
+def _profile_flags(
+    params: ModuleParams,
+    specific_type: str | None,
+    profile_dir: Path,
+) -> tuple[list[str], list[str]]:
+    '''
+    Translate the build profile in *params* into extra compile and link
+    arguments for *specific_type* compilers.
+
+    '''
+    compile_args: list[str] = []
+    link_args: list[str] = []
+
+    if specific_type == 'cl':
+        if params.opt_level is not None:
+            # msvc has no /O3, /O2 is its "maximize speed" level
+            compile_args.append(
+                '/Od' if params.opt_level == 0
+                else f'/O{min(params.opt_level, 2)}'
+            )
+
+        if params.lto:
+            compile_args.append('/GL')
+            link_args.append('/LTCG')
+
+        if params.march_native:
+            logger.warning('march_native has no msvc equivalent, ignoring')
+
+        if params.pgo != 'off':
+            logger.warning('pgo is only supported with gcc & clang, ignoring')
+
+        return compile_args, link_args
+
+    if params.opt_level is not None:
+        compile_args.append(f'-O{params.opt_level}')
+
+    if params.march_native:
+        # arm compilers spell "this cpu" as -mcpu
+        compile_args.append(
+            '-mcpu=native'
+            if platform.machine().lower() in ('arm64', 'aarch64')
+            else '-march=native'
+        )
+
+    if params.lto:
+        # code generation happens at link time with lto, so the linker
+        # needs the same optimization flags
+        link_args += compile_args + ['-flto']
+        compile_args.append('-flto')
+
+    if params.pgo == 'generate':
+        flag = f'-fprofile-generate={profile_dir}'
+        compile_args.append(flag)
+        link_args.append(flag)
+
+    elif params.pgo == 'use':
+        compile_args.append(f'-fprofile-use={profile_dir}')
+        if specific_type == 'gcc':
+            # profiles from a threaded run may be slightly inconsistent and
+            # paths not hit by the sample corpus have no profile at all
+            compile_args += ['-fprofile-correction', '-Wno-missing-profile']
+
+        else:
+            compile_args.append('-Wno-profile-instr-unprofiled')
+
+    return compile_args, link_args
+
+
+def _merge_clang_profile(profile_dir: Path) -> None:
+    '''
+    Clang writes one raw profile per instrumented module run, `-fprofile-use`
+    wants them merged into `<profile_dir>/default.profdata`.
+
+    '''
+    raw = sorted(str(p) for p in profile_dir.glob('*.profraw'))
+    if not raw:
+        raise RuntimeError(f'No raw profiles to merge in {profile_dir}')
+
+    tool = which('llvm-profdata')
+    cmd = [tool] if tool else None
+    if not cmd and py_sys.platform == 'darwin':
+        cmd = ['xcrun', 'llvm-profdata']
+
+    if not cmd:
+        raise RuntimeError(
+            'llvm-profdata is required to build pgo modules with clang'
+        )
+
+    subprocess.run(
+        cmd + ['merge', '-o', str(profile_dir / 'default.profdata'), *raw],
+        check=True
+    )
+
+
 def _compile_with_distutils(
     name: str,
     src: Path,
     build: Path,
     defines: list[str] = [],
-):
+    params: ModuleParams | None = None,
+    profile_dir: Path | None = None,
+    obj_dir: Path | None = None,
+) -> tuple[str, dict]:
     '''
     Compile *src* into <build_dir>/<name><EXT_SUFFIX> with the supported
     compilers:
@@ -52,6 +152,13 @@ def _compile_with_distutils(
         on windows:
             - cl
             - clang
+
+    Object files go to *obj_dir* when set, the shared object always goes to
+    *build*.
+
+    Returns the target file name and the effective compiler & linker
+    command lines.
+
     '''
     cc = ccompiler.new_compiler()
     sysconfig.customize_compiler(cc)
@@ -95,6 +202,20 @@ def _compile_with_distutils(
         # equivalent of -Wno-maybe-uninitialized
         extra = ['/wd4701']
 
+    link_extra: list[str] = []
+    if params is not None:
+        profile_args, profile_link_args = _profile_flags(
+            params,
+            specific_type,
+            profile_dir or build / 'profile'
+        )
+        # appended last so they win over anything in Python's CFLAGS
+        extra += profile_args
+        link_extra += profile_link_args
+
+        if params.pgo == 'use' and specific_type == 'clang':
+            _merge_clang_profile(profile_dir or build / 'profile')
+
     libs: list[str]  = []
     library_dirs: list[str]  = []
 
@@ -131,7 +252,7 @@ def _compile_with_distutils(
     start_compile = time.time()
     objs = cc.compile(
         [str(src)],
-        output_dir=str(build),
+        output_dir=str(obj_dir or build),
         include_dirs=[include_py],
         extra_postargs=extra
     )
@@ -147,11 +268,20 @@ def _compile_with_distutils(
         output_dir=str(build),
         libraries=libs,
         library_dirs=library_dirs,
+        extra_postargs=link_extra
     )
     link_elapsed = time.time() - start_link
     logger.info(f'Done linking, took: {link_elapsed:.2f}s')
     logger.info(f'Total time: {compile_elapsed + link_elapsed:.2f}s')
-    return target
+
+    compile_cmd = getattr(cc, 'compiler_so', None) or [cc.compiler_type]
+    link_cmd = getattr(cc, 'linker_so', None) or [cc.compiler_type]
+    flags = {
+        'compiler': specific_type,
+        'compile': list(compile_cmd) + [f'-D{d}' for d in defines] + extra,
+        'link': list(link_cmd) + link_extra
+    }
+    return target, flags
 
 
 
@@ -160,10 +290,15 @@ def compile_module(
     source: str,
     build_path: Path | str,
     build_params: ModuleParams,
+    *,
+    profile_dir: Path | None = None,
 ):
     '''
     Compile the generated C source into a shared object for import.
 
+    *profile_dir* is where `pgo` builds write or read their profile data,
+    defaults to `<build_path>/profile`.
+
     '''
     # ensure build dir exists
     build_path = Path(build_path)
@@ -173,7 +308,21 @@ def compile_module(
     c_path = build_path / f'{name}.c'
     c_path.write_text(source)
 
+    profile_dir = Path(profile_dir) if profile_dir else build_path / 'profile'
+    obj_dir: Path | None = None
+
     defs = []
+    if build_params.pgo != 'off':
+        # gcc names profile files after the object path, so both pgo stages
+        # compile the same source path into the same object dir
+        profile_dir.mkdir(parents=True, exist_ok=True)
+        c_path = profile_dir / f'{name}.c'
+        c_path.write_text(source)
+        obj_dir = profile_dir / 'obj'
+
+    if build_params.pgo == 'generate':
+        defs.append('__JITABI_PGO_GENERATE')
+
     if build_params.debug:
         defs.append('__JITABI_DEBUG')
 
@@ -183,9 +332,48 @@ def compile_module(
     if build_params.with_pack:
         defs.append('__JITABI_PACK')
 
-    _compile_with_distutils(name, c_path, build_path, defines=defs)
+    if build_params.value_cache:
+        defs.append('__JITABI_VALUE_CACHE')
+
+    if build_params.name_strings:
+        defs.append('__JITABI_NAME_STRINGS')
 
-    # write build params to json file on build dir
+    if build_params.stats != 'off':
+        defs.append('__JITABI_STATS')
+
+    if build_params.stats == 'timing':
+        defs.append('__JITABI_STATS_TIMING')
+
+    _, flags = _compile_with_distutils(
+        name, c_path, build_path,
+        defines=defs,
+        params=build_params,
+        profile_dir=profile_dir,
+        obj_dir=obj_dir
+    )
+
+    # write build params & the flags they turned into to json file on
+    # build dir
     (build_path / 'params.json').write_text(
-        json.dumps(build_params.as_dict(), indent=4)
+        json.dumps({**build_params.as_dict(), 'flags': flags}, indent=4)
     )
+
+
+def compile_runtime(
+    name: str,
+    source: str,
+    build_path: Path | str
+) -> None:
+    '''
+    Compile the shared runtime module source into *build_path*.
+
+    The runtime takes no build params, it's the same for every module.
+
+    '''
+    build_path = Path(build_path)
+    build_path.mkdir(parents=True, exist_ok=True)
+
+    c_path = build_path / f'{name}.c'
+    c_path.write_text(source)
+
+    _compile_with_distutils(name, c_path, build_path)
@@ -0,0 +1,134 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Decode through `antelope_rs` while a module compiles in the background.
+
+`JITContext.module_for_abi_async` hands out an :class:`AsyncModule`, which
+forwards every attribute to an :class:`ABIFallback` until the compile future
+resolves, then to the compiled module.
+
+'''
+from __future__ import annotations
+
+import logging
+
+from types import ModuleType
+from typing import Any
+from concurrent.futures import Future
+
+from antelope_rs import ABIView
+
+from jitabi.cache import CacheKey
+
+
+logger = logging.getLogger(__name__)
+
+
+# module level entry points sharing the per type prefixes, not fallen back to
+_DISPATCH_NAMES = frozenset((
+    'unpack_many', 'unpack_from', 'unpack_columns', 'pack_into'
+))
+
+
+class ABIFallback:
+    '''
+    Module look-alike running `unpack` / `pack` through the ABI itself.
+
+    Only the dispatch style entry points are provided: `unpack(type, buf)`,
+    `pack(type, obj)` and the per type `unpack_<type>` / `pack_<type>`.
+    Values come out of `antelope_rs`, shaped like the `dict` output mode.
+
+    '''
+
+    output: str = 'dict'
+
+    def __init__(self, abi: ABIView):
+        self.abi = abi
+
+    def unpack(self, type_name: str, buf: Any) -> Any:
+        return self.abi.unpack(type_name, bytes(buf))
+
+    def pack(self, type_name: str, obj: Any) -> bytes:
+        return self.abi.pack(type_name, obj)
+
+    def __getattr__(self, name: str) -> Any:
+        if name in _DISPATCH_NAMES:
+            raise AttributeError(
+                f'{name} is not available until the module is compiled')
+
+        for prefix in ('unpack_', 'pack_'):
+            if name.startswith(prefix):
+                type_name = name[len(prefix):]
+                fn = getattr(self, prefix[:-1])
+                return lambda value: fn(type_name, value)
+
+        raise AttributeError(
+            f'{name} is not available until the module is compiled')
+
+
+class AsyncModule:
+    '''
+    Stand-in for a module being compiled, attributes are served by
+    *fallback* until *future* resolves to `(key, module)`.
+
+    A failed compile is logged once and the fallback keeps serving,
+    `future.result()` re-raises the error for callers that care.
+
+    '''
+
+    def __init__(
+        self,
+        future: Future[tuple[CacheKey, ModuleType]],
+        fallback: ABIFallback
+    ):
+        self.future = future
+        self.fallback = fallback
+        self._module: ModuleType | None = None
+
+        future.add_done_callback(self._on_done)
+
+    def _on_done(self, future: Future) -> None:
+        try:
+            _, module = future.result()
+
+        except BaseException:
+            logger.exception('Background compile failed, staying on fallback')
+            return
+
+        self._module = module
+
+    @property
+    def ready(self) -> bool:
+        return self._module is not None
+
+    @property
+    def module(self) -> ModuleType | None:
+        '''
+        The compiled module, `None` until it can be imported.
+
+        '''
+        return self._module
+
+    def wait(self, timeout: float | None = None) -> ModuleType:
+        '''
+        Block until the compile is done and return the compiled module.
+
+        '''
+        _, module = self.future.result(timeout=timeout)
+        return module
+
+    def __getattr__(self, name: str) -> Any:
+        return getattr(self._module or self.fallback, name)
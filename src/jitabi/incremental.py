@@ -0,0 +1,306 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Incremental rebuilds for ABIs that change a few types at a time (frequent
+`setabi`s).
+
+Every module build records a content hash per ABI type in `types.json`,
+covering the type's definition and everything it references. When a new
+version of the ABI comes in, only the types whose hash changed (which
+includes every type depending on a changed one) are compiled, together with
+what they reference, into a small delta module. :class:`CompositeModule`
+serves those types from the delta and everything else from the module
+already built for the previous version.
+
+Generated modules are a single translation unit made of `static` functions
+sharing the module state, so the unit of reuse is a whole compiled module
+rather than per type object files.
+
+'''
+from __future__ import annotations
+
+import re
+import json
+import hashlib
+
+from types import ModuleType
+from typing import Any, Callable
+from pathlib import Path
+
+
+TYPES_FILE = 'types.json'
+
+# trailing modifiers of a type expression: `[]`, `?`, `$`
+_MODS_RE = re.compile(r'(?:\[\]|\?|\$)+$')
+
+# module functions taking a type expression as first argument
+_DISPATCH_FUNCTIONS: frozenset[str] = frozenset({
+    'type',
+    'unpack',
+    'unpack_many',
+    'unpack_from',
+    'iter_unpack',
+    'sizeof_packed',
+    'array_offsets',
+    'field_offsets',
+    'unpack_columns',
+    'projection',
+    'pack',
+    'pack_into',
+})
+
+
+def base_type(type_expr: str) -> str:
+    '''
+    *type_expr* without its modifier chain, `action[]?` -> `action`.
+
+    '''
+    return _MODS_RE.sub('', type_expr)
+
+
+def _definitions(abi) -> dict[str, tuple[str, list[str]]]:
+    '''
+    Canonical definition & referenced type names of every struct, variant
+    and alias in *abi*.
+
+    '''
+    defs: dict[str, tuple[str, list[str]]] = {}
+    for s in abi.structs:
+        fields = [(f.name, f.type_) for f in s.fields]
+        refs = [base_type(t) for _, t in fields]
+        if s.base:
+            refs.append(s.base)
+
+        defs[s.name] = (
+            json.dumps(['struct', s.name, s.base or '', fields]),
+            refs
+        )
+
+    for v in abi.variants:
+        types = list(v.types)
+        defs[v.name] = (
+            json.dumps(['variant', v.name, types]),
+            [base_type(t) for t in types]
+        )
+
+    for a in abi.types:
+        defs[a.new_type_name] = (
+            json.dumps(['alias', a.new_type_name, a.type_]),
+            [base_type(a.type_)]
+        )
+
+    return defs
+
+
+def _reachable(
+    defs: dict[str, tuple[str, list[str]]],
+    names: set[str]
+) -> set[str]:
+    '''
+    *names* plus every ABI type they reference, directly or not.
+
+    '''
+    seen: set[str] = set()
+    stack = [n for n in names if n in defs]
+    while stack:
+        name = stack.pop()
+        if name in seen:
+            continue
+
+        seen.add(name)
+        stack += [r for r in defs[name][1] if r in defs and r not in seen]
+
+    return seen
+
+
+def type_hashes(abi) -> dict[str, str]:
+    '''
+    Hash of every struct, variant and alias in *abi*, over the definitions
+    of all the types it reaches. A type's hash changes whenever it or
+    anything it references does, cycles included.
+
+    '''
+    defs = _definitions(abi)
+    hashes: dict[str, str] = {}
+    for name in defs:
+        h = hashlib.sha256()
+        for dep in sorted(_reachable(defs, {name})):
+            h.update(defs[dep][0].encode())
+
+        hashes[name] = h.hexdigest()
+
+    return hashes
+
+
+def write_type_hashes(mod_dir: Path, abi, pipeline: str) -> None:
+    (mod_dir / TYPES_FILE).write_text(json.dumps({
+        'pipeline': pipeline,
+        'types': type_hashes(abi)
+    }))
+
+
+def read_type_hashes(mod_dir: Path, pipeline: str) -> dict[str, str] | None:
+    '''
+    Type hashes recorded for the module in *mod_dir*, `None` when missing or
+    written by a different codegen pipeline.
+
+    '''
+    path = mod_dir / TYPES_FILE
+    if not path.is_file():
+        return None
+
+    meta = json.loads(path.read_text())
+    if meta.get('pipeline') != pipeline:
+        return None
+
+    return meta['types']
+
+
+class SubsetABI:
+    '''
+    ABIView protocol view over the *names* types of *abi* and everything
+    they reference, the input codegen renders a delta module from.
+
+    '''
+
+    def __init__(self, abi, names: set[str]):
+        self.abi = abi
+        self.names = _reachable(_definitions(abi), names)
+
+    @property
+    def structs(self) -> list:
+        return [s for s in self.abi.structs if s.name in self.names]
+
+    @property
+    def variants(self) -> list:
+        return [v for v in self.abi.variants if v.name in self.names]
+
+    @property
+    def types(self) -> list:
+        return [a for a in self.abi.types if a.new_type_name in self.names]
+
+    def resolve_type(self, type_name: str):
+        return self.abi.resolve_type(type_name)
+
+
+def changed_types(
+    base: dict[str, str],
+    current: dict[str, str]
+) -> set[str]:
+    '''
+    Types of *current* that the module built with *base* hashes can't serve.
+
+    '''
+    return {
+        name for name, h in current.items()
+        if base.get(name) != h
+    }
+
+
+class CompositeModule:
+    '''
+    Module look-alike serving *delta_types* from *delta* and every other
+    type from *base*, except the *removed* ones: types *base* was built
+    with that the current ABI no longer has.
+
+    Per type functions (`unpack_<type>`, `pack_<type>`) are the modules' own,
+    dispatch functions (`unpack`, `pack`, `type`...) route on the base name of
+    their type expression first.
+
+    '''
+
+    def __init__(
+        self,
+        base: ModuleType,
+        delta: ModuleType | None,
+        delta_types: set[str],
+        types: set[str],
+        removed: set[str] = set()
+    ):
+        self.base = base
+        self.delta = delta
+        self.delta_types = frozenset(delta_types)
+        self.types = frozenset(types)
+        self.removed = frozenset(removed)
+        self.output: str = base.output
+
+    def module_for(self, type_expr: str) -> ModuleType:
+        name = base_type(type_expr)
+        if name in self.delta_types:
+            return self.delta
+
+        if name in self.removed:
+            # same error the module raises for unknown types
+            raise ValueError(f"unknown type '{type_expr}'")
+
+        return self.base
+
+    @property
+    def structs(self) -> dict:
+        structs = {
+            name: seq for name, seq in self.base.structs.items()
+            if name not in self.removed
+        }
+        if self.delta is not None:
+            structs.update({
+                name: seq for name, seq in self.delta.structs.items()
+                if name in self.delta_types
+            })
+
+        return structs
+
+    def stats(self, reset: bool = False) -> dict:
+        '''
+        Counters of both modules (stats builds only), summed per type.
+
+        '''
+        merged: dict[str, dict[str, dict[str, int]]] = self.base.stats(reset=reset)
+        if self.delta is None:
+            return merged
+
+        for direction, types in self.delta.stats(reset=reset).items():
+            totals = merged.setdefault(direction, {})
+            for type_name, counters in types.items():
+                prev = totals.setdefault(type_name, dict.fromkeys(counters, 0))
+                for key, value in counters.items():
+                    prev[key] += value
+
+        return merged
+
+    def _dispatch(self, fn_name: str) -> Callable:
+        def call(type_expr: str, *args, **kwargs) -> Any:
+            module = self.module_for(type_expr)
+            return getattr(module, fn_name)(type_expr, *args, **kwargs)
+
+        return call
+
+    def __getattr__(self, name: str) -> Any:
+        if name in _DISPATCH_FUNCTIONS:
+            attr = self._dispatch(name)
+
+        elif name.startswith(('unpack_', 'pack_')):
+            type_name = name.split('_', 1)[1]
+            if type_name not in self.types:
+                raise AttributeError(name)
+
+            attr = getattr(self.module_for(type_name), name)
+
+        else:
+            return getattr(self.base, name)
+
+        # later lookups hit the instance dict
+        setattr(self, name, attr)
+        return attr
@@ -0,0 +1,149 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Decode big arrays (a block's `transaction_receipt[]`, a trace's
+`action_trace[]`...) on a thread pool.
+
+Item boundaries are found by the module's skip functions (`array_offsets`),
+the array is then cut into one contiguous chunk per worker, each chunk
+decoded with a single `unpack_many` call and the chunk lists concatenated
+back in order.
+
+Creating Python objects needs an attached thread state, so chunks only
+decode in parallel on free-threaded CPython builds. With the GIL, threads
+would just take turns, so by default arrays are decoded in one call there.
+
+'''
+import os
+import sys
+
+from types import ModuleType
+from typing import Any
+from concurrent.futures import Executor, ThreadPoolExecutor
+
+
+# arrays with less items than this are decoded in one call, splitting them
+# costs more than it saves
+PARALLEL_MIN_ITEMS: int = 1024
+
+
+def gil_enabled() -> bool:
+    check = getattr(sys, '_is_gil_enabled', None)
+    return check() if check else True
+
+
+def unpack_array(
+    module: ModuleType,
+    item_type: str,
+    buf: Any,
+    offset: int = 0,
+    *,
+    min_items: int = PARALLEL_MIN_ITEMS,
+    workers: int | None = None,
+    executor: Executor | None = None,
+    threads: bool | None = None,
+) -> list:
+    '''
+    Decode the encoded `<item_type>[]` array at *offset* of *buf*, same
+    result as `module.unpack(item_type + "[]", buf[offset:])`.
+
+    Arrays of at least *min_items* items are split in *workers* chunks
+    (default: one per cpu) and decoded on *executor*, or on a pool created
+    for the call. *threads* forces (True) or prevents (False) the split,
+    by default it only happens without a GIL.
+
+    '''
+    bounds = module.array_offsets(item_type, buf, offset)
+    count = len(bounds) - 1
+
+    if threads is None:
+        threads = not gil_enabled()
+
+    workers = workers or os.cpu_count() or 1
+    if not threads or count < max(min_items, 2) or workers < 2:
+        return module.unpack_many(item_type, buf, bounds)
+
+    step = -(-count // workers)
+    chunks = [
+        bounds[start:start + step + 1]
+        for start in range(0, count, step)
+    ]
+
+    def decode(chunk: list[int]) -> list:
+        return module.unpack_many(item_type, buf, chunk)
+
+    if executor is None:
+        with ThreadPoolExecutor(max_workers=len(chunks)) as pool:
+            parts = list(pool.map(decode, chunks))
+
+    else:
+        parts = list(executor.map(decode, chunks))
+
+    items = parts[0]
+    for part in parts[1:]:
+        items.extend(part)
+
+    return items
+
+
+def unpack_struct(
+    module: ModuleType,
+    type_name: str,
+    buf: Any,
+    field: str,
+    offset: int = 0,
+    **kwargs
+) -> Any:
+    '''
+    Decode the *type_name* struct at *offset* of *buf* with its array
+    *field* (e.g. `signed_block.transactions`) decoded by `unpack_array`,
+    *kwargs* are passed through to it. Every other field is decoded as
+    usual, the result is what `module.unpack(type_name, buf[offset:])`
+    returns.
+
+    '''
+    if module.output == 'lazy':
+        raise ValueError(
+            'lazy structs already decode fields on first read, '
+            'use unpack_array on the field offsets instead'
+        )
+
+    names: list[str] = []
+    values: list = []
+    for name, ftype, start in module.field_offsets(type_name, buf, offset):
+        if name == field:
+            if not ftype.endswith('[]'):
+                raise ValueError(
+                    f'field {field} of {type_name} is not an array: {ftype}')
+
+            value = unpack_array(module, ftype[:-2], buf, start, **kwargs)
+
+        else:
+            value, _ = module.unpack_from(ftype, buf, start)
+
+        names.append(name)
+        values.append(value)
+
+    if field not in names:
+        raise ValueError(f'{type_name} has no field {field}')
+
+    if module.output == 'tuple':
+        return tuple(values)
+
+    if module.output == 'structseq':
+        return module.structs[type_name](values)
+
+    return dict(zip(names, values))
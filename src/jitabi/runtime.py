@@ -0,0 +1,111 @@
+# py-jitabi: Create JIT compiled CPython modules from antelope protocol ABIs
+# Copyright 2025-eternity Guillermo Rodriguez
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+'''
+Shared runtime module for the std codecs every generated module uses.
+
+Cold codecs (128 bit ints, name & symbol string forms) live in a single
+`_jitabi_rt` extension compiled once per cache and loaded once per process,
+generated modules reach them through the `jitabi._rt.CAPI` capsule the
+first time one of them is imported.
+
+`jitabi._rt` only exists in the interpreter that called `load_runtime`. So
+a module's first import in the process has to happen there. Imports from
+other interpreters after that, subinterpreters included, reuse the table
+the first one bound.
+
+The runtime is stored under `<cache_root>/.runtime/<hash>/`, keyed by the
+hash of its sources.
+
+'''
+from __future__ import annotations
+
+import sys
+import hashlib
+import logging
+
+from types import ModuleType
+from pathlib import Path
+
+import jitabi
+import jitabi.templates as templates
+
+from jitabi.cache import EXT_SUFFIX, Cache, import_module
+from jitabi.compiler import compile_runtime
+
+
+logger = logging.getLogger(__name__)
+
+
+RUNTIME_NAME = '_jitabi_rt'
+
+# where generated modules look the runtime up, see templates/jitabi_rt.h
+RUNTIME_MODULE = 'jitabi._rt'
+
+_RUNTIME_SOURCES = ('jitabi_rt.h', 'runtime.c.j2')
+
+
+def runtime_hash() -> str:
+    hasher = hashlib.sha256()
+    for name in _RUNTIME_SOURCES:
+        source, *_ = templates.env.loader.get_source(templates.env, name)
+        hasher.update(source.encode('utf-8'))
+
+    return hasher.hexdigest()
+
+
+def runtime_dir(cache: Cache) -> Path:
+    return cache.fs_location / '.runtime' / runtime_hash()
+
+
+def loaded_runtime() -> ModuleType | None:
+    return sys.modules.get(RUNTIME_MODULE)
+
+
+def load_runtime(cache: Cache, *, build: bool = True) -> ModuleType | None:
+    '''
+    Import the runtime from *cache*, compiling it first when missing and
+    *build* is set. Returns `None` when it's neither built nor buildable.
+
+    The first runtime loaded in the process stays, the table it exports is
+    versioned and generated modules bind it only once. With *build* set
+    *cache* still gets its own copy, so it can be shipped without the cache
+    the process loaded the runtime from.
+
+    '''
+    rt_dir = runtime_dir(cache)
+    mod_path = rt_dir / f'{RUNTIME_NAME}{EXT_SUFFIX}'
+    if not mod_path.is_file() and build:
+        rt_dir.mkdir(parents=True, exist_ok=True)
+        with cache.dir_lock(rt_dir, shared=False):
+            # another process might have built it while we waited
+            if not mod_path.is_file():
+                logger.info(f'Compiling jitabi runtime at {rt_dir}')
+                source = templates.runtime_tmpl.render(m_name=RUNTIME_NAME)
+                compile_runtime(RUNTIME_NAME, source, rt_dir)
+
+    module = loaded_runtime()
+    if module is not None:
+        return module
+
+    if not mod_path.is_file():
+        return None
+
+    with cache.dir_lock(rt_dir, shared=True):
+        module = import_module(RUNTIME_NAME, mod_path)
+
+    sys.modules[RUNTIME_MODULE] = module
+    jitabi._rt = module
+    return module
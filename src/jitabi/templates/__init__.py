@@ -30,15 +30,29 @@ unpack_enum_tmpl = env.get_template('unpack_enum.c.j2')
 pack_enum_tmpl = env.get_template('pack_enum.c.j2')
 unpack_struct_tmpl = env.get_template('unpack_struct.c.j2')
 pack_struct_tmpl = env.get_template('pack_struct.c.j2')
+skip_alias_tmpl = env.get_template('skip_alias.c.j2')
+skip_enum_tmpl = env.get_template('skip_enum.c.j2')
+skip_struct_tmpl = env.get_template('skip_struct.c.j2')
+runtime_tmpl = env.get_template('runtime.c.j2')
 
 _template_names = [
+    'jitabi_rt.h',
     'macros.c.j2',
     'module.c.j2',
     'pack_alias.c.j2',
     'pack_enum.c.j2',
+    'pack_std.c',
     'pack_struct.c.j2',
+    'runtime.c.j2',
+    'skip_alias.c.j2',
+    'skip_enum.c.j2',
+    'skip_struct.c.j2',
     'unpack_alias.c.j2',
+    'unpack_columns.c',
     'unpack_enum.c.j2',
+    'unpack_lazy.c',
+    'unpack_projection.c',
+    'unpack_std.c',
     'unpack_struct.c.j2',
 ]
 
@@ -0,0 +1,30 @@
+// function table of the shared runtime module (`jitabi._rt`, rendered from
+// templates/runtime.c.j2), exported through its `CAPI` capsule.
+//
+// Cold std codecs (128 bit ints, name & symbol string forms) are compiled
+// once per process there instead of once per generated module. Hot ones
+// (fixed width ints, varints, strings) stay inline in every module, an
+// indirect call per field would cost more than the duplicated code.
+
+#define JITABI_RT_CAPSULE "jitabi._rt.CAPI"
+#define JITABI_RT_VERSION 1
+
+struct jitabi_rt_api {
+    int version;
+
+    // 128 bit ints from / to their little endian 64 bit halves, `*_to_halves`
+    // return -1 with an exception set when `obj` is out of range
+    PyObject *(*uint128_from_halves)(uint64_t hi, uint64_t lo);
+    PyObject *(*int128_from_halves)(uint64_t hi, uint64_t lo);
+    int (*uint128_to_halves)(PyObject *obj, uint64_t *hi, uint64_t *lo);
+    int (*int128_to_halves)(PyObject *obj, uint64_t *hi, uint64_t *lo);
+
+    // string forms of name-like values, `*_from_str` return -1 (no exception
+    // set) when the string isn't a valid one
+    PyObject *(*name_to_str)(uint64_t v);
+    PyObject *(*symbol_to_str)(uint64_t v);
+    PyObject *(*symbol_code_to_str)(uint64_t v);
+    int (*name_from_str)(const char *s, Py_ssize_t len, uint64_t *out);
+    int (*symbol_from_str)(const char *s, Py_ssize_t len, uint64_t *out);
+    int (*symbol_code_from_str)(const char *s, Py_ssize_t len, uint64_t *out);
+};
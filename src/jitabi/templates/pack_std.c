@@ -1,6 +1,12 @@
 
 static JITABI_INLINE ssize_t encode_varuint32(unsigned long long val, char *out)
 {
+    // lengths & small ints, the common case
+    if (val < 0x80) {
+        out[0] = (char)val;
+        return 1;
+    }
+
     size_t i = 0;
     do {
         unsigned char b = val & 0x7F;
@@ -35,8 +41,51 @@ static JITABI_INLINE ssize_t encode_varint32(long long val, char *out)
     return (ssize_t)i;
 }
 
+// bounds checked varuint32 write, returns JITABI_PACK_OVERFLOW when `out`
+// can't hold the encoding
+static JITABI_INLINE ssize_t write_varuint32(unsigned long long val, char *out, size_t out_len)
+{
+    if (out_len >= 10)
+        return encode_varuint32(val, out);
+
+    char tmp[10];
+    ssize_t len = encode_varuint32(val, tmp);
+    if ((size_t)len > out_len)
+        return JITABI_PACK_OVERFLOW;
+
+    memcpy(out, tmp, (size_t)len);
+    return len;
+}
+
+static JITABI_INLINE ssize_t write_varint32(long long val, char *out, size_t out_len)
+{
+    if (out_len >= 10)
+        return encode_varint32(val, out);
+
+    char tmp[10];
+    ssize_t len = encode_varint32(val, tmp);
+    if ((size_t)len > out_len)
+        return JITABI_PACK_OVERFLOW;
+
+    memcpy(out, tmp, (size_t)len);
+    return len;
+}
+
+// bail out of the current pack_* call when fewer than `n` bytes remain
+#define JITABI_NEED_SPACE(n)                                             \
+    do {                                                                 \
+        if (out_len < (n))                                               \
+            return JITABI_PACK_OVERFLOW;                                 \
+    } while (0)
+
+// arrays pack from lists or tuples, items are read from a `seq_snapshot` of
+// them
+#define JITABI_SEQ_CHECK(o) (PyList_Check(o) || PyTuple_Check(o))
+
 static JITABI_INLINE ssize_t pack_bool(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(1);
+
     int res = PyObject_IsTrue(obj);
     if (res < 0) return -1;
     out[0] = (char)(res ? 1 : 0);
@@ -45,6 +94,8 @@ static JITABI_INLINE ssize_t pack_bool(PyObject *obj, char *out, size_t out_len)
 
 static JITABI_INLINE ssize_t pack_uint8(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(1);
+
     unsigned long val = PyLong_AsUnsignedLong(obj);
     if (PyErr_Occurred()) return -1;
     if (val > 0xFF) {
@@ -57,6 +108,8 @@ static JITABI_INLINE ssize_t pack_uint8(PyObject *obj, char *out, size_t out_len
 
 static JITABI_INLINE ssize_t pack_uint16(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(2);
+
     unsigned long val = PyLong_AsUnsignedLong(obj);
     if (PyErr_Occurred()) return -1;
     if (val > 0xFFFF) {
@@ -72,6 +125,8 @@ static JITABI_INLINE ssize_t pack_uint16(PyObject *obj, char *out, size_t out_le
 
 static JITABI_INLINE ssize_t pack_uint32(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(4);
+
     unsigned long val = PyLong_AsUnsignedLong(obj);
     if (PyErr_Occurred()) return -1;
 
@@ -93,6 +148,8 @@ static JITABI_INLINE ssize_t pack_uint32(PyObject *obj, char *out, size_t out_le
 
 static JITABI_INLINE ssize_t pack_uint64(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(8);
+
     unsigned long long val = PyLong_AsUnsignedLongLong(obj);
     if (PyErr_Occurred()) return -1;
 
@@ -111,33 +168,15 @@ static JITABI_INLINE ssize_t pack_uint64(PyObject *obj, char *out, size_t out_le
 static JITABI_INLINE ssize_t
 pack_uint128(PyObject *obj, char *out, size_t out_len)
 {
-    if (out_len < 16) {
-        PyErr_SetString(PyExc_ValueError, "output buffer too small");
-        return -1;
-    }
+    JITABI_NEED_SPACE(16);
     if (!PyLong_Check(obj)) {
         PyErr_SetString(PyExc_TypeError, "expected int for uint128");
         return -1;
     }
 
-    /* low 64 bits  */
-    PyObject *mask_lo = PyLong_FromUnsignedLongLong(0xFFFFFFFFFFFFFFFFULL);
-    if (!mask_lo) return -1;
-    PyObject *lo_obj  = PyNumber_And(obj, mask_lo);
-    Py_DECREF(mask_lo);
-    if (!lo_obj) return -1;
-
-    /* high 64 bits */
-    PyObject *shift_amt = PyLong_FromLong(64);
-    if (!shift_amt) { Py_DECREF(lo_obj); return -1; }
-    PyObject *hi_obj    = PyNumber_Rshift(obj, shift_amt);
-    Py_DECREF(shift_amt);
-    if (!hi_obj) { Py_DECREF(lo_obj); return -1; }
-
-    uint64_t lo = PyLong_AsUnsignedLongLong(lo_obj);
-    uint64_t hi = PyLong_AsUnsignedLongLong(hi_obj);
-    Py_DECREF(lo_obj); Py_DECREF(hi_obj);
-    if (PyErr_Occurred()) return -1;
+    uint64_t hi, lo;
+    if (uint128_to_halves(obj, &hi, &lo) < 0)
+        return -1;
 
     memcpy(out,      &lo, 8);
     memcpy(out + 8,  &hi, 8);
@@ -146,6 +185,8 @@ pack_uint128(PyObject *obj, char *out, size_t out_len)
 
 static JITABI_INLINE ssize_t pack_int8(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(1);
+
     long val = PyLong_AsLong(obj);
     if (PyErr_Occurred()) return -1;
     if (val < -128 || val > 127) {
@@ -158,6 +199,8 @@ static JITABI_INLINE ssize_t pack_int8(PyObject *obj, char *out, size_t out_len)
 
 static JITABI_INLINE ssize_t pack_int16(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(2);
+
     long val = PyLong_AsLong(obj);
     if (PyErr_Occurred()) return -1;
     if (val < -32768 || val > 32767) {
@@ -173,6 +216,8 @@ static JITABI_INLINE ssize_t pack_int16(PyObject *obj, char *out, size_t out_len
 
 static JITABI_INLINE ssize_t pack_int32(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(4);
+
     long val = PyLong_AsLong(obj);
     if (PyErr_Occurred()) return -1;
 
@@ -191,6 +236,8 @@ static JITABI_INLINE ssize_t pack_int32(PyObject *obj, char *out, size_t out_len
 
 static JITABI_INLINE ssize_t pack_int64(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(8);
+
     long long val = PyLong_AsLongLong(obj);
     if (PyErr_Occurred()) return -1;
 
@@ -209,46 +256,15 @@ static JITABI_INLINE ssize_t pack_int64(PyObject *obj, char *out, size_t out_len
 static JITABI_INLINE ssize_t
 pack_int128(PyObject *obj, char *out, size_t out_len)
 {
-    if (out_len < 16) {
-        PyErr_SetString(PyExc_ValueError, "output buffer too small");
-        return -1;
-    }
+    JITABI_NEED_SPACE(16);
     if (!PyLong_Check(obj)) {
         PyErr_SetString(PyExc_TypeError, "expected int for int128");
         return -1;
     }
 
-    PyObject *zero = PyLong_FromLong(0);
-    if (!zero) return -1;
-    const int sign = PyObject_RichCompareBool(obj, zero, Py_LT);
-    Py_DECREF(zero);
-    if (sign < 0) return -1;
-
-    PyObject *abs_obj = sign
-        ? PyNumber_Negative(obj)
-        : obj;
-    if (!abs_obj) return -1;
-    /* now we own one ref in both cases */
-
-    /* magnitude halves                                                  */
-    PyObject *lo_obj = PyNumber_And(
-        abs_obj, PyLong_FromUnsignedLongLong(0xFFFFFFFFFFFFFFFFULL));
-    if (!lo_obj) { Py_DECREF(abs_obj); return -1; }
-
-    PyObject *hi_obj = PyNumber_Rshift(abs_obj, PyLong_FromLong(64));
-    if (!hi_obj) { Py_DECREF(abs_obj); Py_DECREF(lo_obj); return -1; }
-
-    uint64_t lo = PyLong_AsUnsignedLongLong(lo_obj);
-    uint64_t hi = PyLong_AsUnsignedLongLong(hi_obj);
-    Py_DECREF(abs_obj); Py_DECREF(lo_obj); Py_DECREF(hi_obj);
-    if (PyErr_Occurred()) return -1;
-
-    if (sign) {                                   /* two’s complement      */
-        lo = ~lo;
-        hi = ~hi;
-        lo += 1;
-        if (lo == 0) hi += 1;
-    }
+    uint64_t hi, lo;
+    if (int128_to_halves(obj, &hi, &lo) < 0)
+        return -1;
 
     memcpy(out,     &lo, 8);
     memcpy(out + 8, &hi, 8);
@@ -260,7 +276,13 @@ static JITABI_INLINE ssize_t pack_varuint32(PyObject *obj, char *out, size_t out
     unsigned long long val = PyLong_AsUnsignedLongLong(obj);
     if (PyErr_Occurred()) return -1;
 
-    return encode_varuint32(val, out);
+    // decoders read at most 5 bytes
+    if (val > 0xFFFFFFFFULL) {
+        PyErr_SetString(PyExc_OverflowError, "varuint32 out of range");
+        return -1;
+    }
+
+    return write_varuint32(val, out, out_len);
 }
 
 static JITABI_INLINE ssize_t pack_varint32(PyObject *obj, char *out, size_t out_len)
@@ -268,11 +290,18 @@ static JITABI_INLINE ssize_t pack_varint32(PyObject *obj, char *out, size_t out_
     long long val = PyLong_AsLongLong(obj);
     if (PyErr_Occurred()) return -1;
 
-    return encode_varint32(val, out);
+    if (val < INT32_MIN || val > INT32_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "varint32 out of range");
+        return -1;
+    }
+
+    return write_varint32(val, out, out_len);
 }
 
 static JITABI_INLINE ssize_t pack_float32(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(4);
+
     float f = (float)PyFloat_AsDouble(obj);
     if (PyErr_Occurred()) return -1;
     memcpy(out, &f, 4);
@@ -281,6 +310,8 @@ static JITABI_INLINE ssize_t pack_float32(PyObject *obj, char *out, size_t out_l
 
 static JITABI_INLINE ssize_t pack_float64(PyObject *obj, char *out, size_t out_len)
 {
+    JITABI_NEED_SPACE(8);
+
     double d = PyFloat_AsDouble(obj);
     if (PyErr_Occurred()) return -1;
     memcpy(out, &d, 8);
@@ -299,13 +330,16 @@ static JITABI_INLINE ssize_t pack_raw(PyObject *obj, size_t len, char *out, size
     if (PyBytes_AsStringAndSize(obj, &data, &size) < 0)
         return -1;
 
-    if ((size_t)size > out_len) {
-        PyErr_SetString(PyExc_ValueError, "output buffer too small for raw data");
+    // fixed size arrays pack items into exactly `len` bytes each
+    if ((size_t)size != len) {
+        PyErr_Format(PyExc_ValueError, "expected %zu bytes, got %zd", len, size);
         return -1;
     }
 
-    memcpy(out, data, (size_t)size);
-    return size;
+    JITABI_NEED_SPACE(len);
+
+    memcpy(out, data, len);
+    return (ssize_t)len;
 }
 
 static JITABI_INLINE ssize_t pack_bytes(PyObject *obj, char *out, size_t out_len)
@@ -323,10 +357,8 @@ static JITABI_INLINE ssize_t pack_bytes(PyObject *obj, char *out, size_t out_len
     char len_buf[10];
     ssize_t len_len = encode_varuint32((unsigned long long)size, len_buf);
 
-    if ((size_t)(len_len + size) > out_len) {
-        PyErr_SetString(PyExc_ValueError, "output buffer too small for bytes");
-        return -1;
-    }
+    if ((size_t)(len_len + size) > out_len)
+        return JITABI_PACK_OVERFLOW;
 
     memcpy(out, len_buf, (size_t)len_len);
     memcpy(out + len_len, data, (size_t)size);
@@ -349,10 +381,8 @@ static JITABI_INLINE ssize_t pack_string(PyObject *obj, char *out, size_t out_le
     char len_buf[10];
     ssize_t len_len = encode_varuint32((unsigned long long)size, len_buf);
 
-    if ((size_t)(len_len + size) > out_len) {
-        PyErr_SetString(PyExc_ValueError, "output buffer too small for string");
-        return -1;
-    }
+    if ((size_t)(len_len + size) > out_len)
+        return JITABI_PACK_OVERFLOW;
 
     memcpy(out, len_buf, (size_t)len_len);
     memcpy(out + len_len, utf8, (size_t)size);
@@ -361,137 +391,53 @@ static JITABI_INLINE ssize_t pack_string(PyObject *obj, char *out, size_t out_le
 }
 
 
-// default structs
+#ifdef __JITABI_NAME_STRINGS
 
-static ssize_t pack_asset(PyObject *__obj, char *__dst, size_t __dst_len)
+// name-like values take their string form or the raw int
+static ssize_t pack_name_like(PyObject *obj, char *out, size_t out_len, enum name_kind kind)
 {
+    if (!PyUnicode_Check(obj))
+        return pack_uint64(obj, out, out_len);
 
-    ssize_t __offset = 0;
-    ssize_t __consumed = 0;
-
-    JITABI_LOG_DEBUG("PACK struct asset:");
-
+    JITABI_NEED_SPACE(8);
 
+    Py_ssize_t len;
+    const char *s = PyUnicode_AsUTF8AndSize(obj, &len);
+    if (!s)
+        return -1;
 
-    PyObject *__field = NULL;
-
-
-    {
-        // -------- field "amount": "int64" --------
-
-        JITABI_LOG_DEBUG(
-            "%s: %s",
-            "amount",
-            "int64"
-        );
-
-        __field = PyDict_GetItemString(__obj, "amount");
-        if (!__field) {
-            PyErr_SetString(PyExc_KeyError, "missing field 'amount'");
-            return -1;
-        }
-        __consumed = pack_int64(
-            __field
-            , __dst + __offset
-            , __dst_len - __offset
-        );
-
-        if (__consumed < 0) return -1;
-        __offset += __consumed;
-        JITABI_LOG_DEBUG("amount packed, offset: %lu", __offset);
+    uint64_t v;
+    int res;
+    const char *what;
+    switch (kind) {
+        case JITABI_KIND_SYMBOL:
+            res = symbol_from_str(s, len, &v);
+            what = "symbol";
+            break;
+        case JITABI_KIND_SYMBOL_CODE:
+            res = symbol_code_from_str(s, len, &v);
+            what = "symbol_code";
+            break;
+        default:
+            res = name_from_str(s, len, &v);
+            what = "name";
+            break;
     }
-    {
-        // -------- field "symbol": "symbol" --------
-
-        JITABI_LOG_DEBUG(
-            "%s: %s",
-            "symbol",
-            "symbol"
-        );
-
-        __field = PyDict_GetItemString(__obj, "symbol");
-        if (!__field) {
-            PyErr_SetString(PyExc_KeyError, "missing field 'symbol'");
-            return -1;
-        }
-        __consumed = pack_uint64(
-            __field
-            , __dst + __offset
-            , __dst_len - __offset
-        );
-
-        if (__consumed < 0) return -1;
-        __offset += __consumed;
-        JITABI_LOG_DEBUG("symbol packed, offset: %lu", __offset);
+    if (res < 0) {
+        PyErr_Format(PyExc_ValueError, "invalid %s %R", what, obj);
+        return -1;
     }
 
-    return __offset;
+    for (int i = 0; i < 8; i++)
+        out[i] = (char)((v >> (8 * i)) & 0xFF);
+    return 8;
 }
 
-static ssize_t pack_extended_asset(PyObject *__obj, char *__dst, size_t __dst_len)
-{
-
-    ssize_t __offset = 0;
-    ssize_t __consumed = 0;
-
-    JITABI_LOG_DEBUG("PACK struct extended_asset:");
-
-
+#else
 
-    PyObject *__field = NULL;
+#define pack_name_like(obj, out, out_len, kind) pack_uint64(obj, out, out_len)
 
-
-    {
-        // -------- field "quantity": "asset" --------
-
-        JITABI_LOG_DEBUG(
-            "%s: %s",
-            "quantity",
-            "asset"
-        );
-
-        __field = PyDict_GetItemString(__obj, "quantity");
-        if (!__field) {
-            PyErr_SetString(PyExc_KeyError, "missing field 'quantity'");
-            return -1;
-        }
-        __consumed = pack_asset(
-            __field
-            , __dst + __offset
-            , __dst_len - __offset
-        );
-
-        if (__consumed < 0) return -1;
-        __offset += __consumed;
-        JITABI_LOG_DEBUG("quantity packed, offset: %lu", __offset);
-    }
-    {
-        // -------- field "contract": "name" --------
-
-        JITABI_LOG_DEBUG(
-            "%s: %s",
-            "contract",
-            "name"
-        );
-
-        __field = PyDict_GetItemString(__obj, "contract");
-        if (!__field) {
-            PyErr_SetString(PyExc_KeyError, "missing field 'contract'");
-            return -1;
-        }
-        __consumed = pack_uint64(
-            __field
-            , __dst + __offset
-            , __dst_len - __offset
-        );
-
-        if (__consumed < 0) return -1;
-        __offset += __consumed;
-        JITABI_LOG_DEBUG("contract packed, offset: %lu", __offset);
-    }
-
-    return __offset;
-}
+#endif
 
 
 // default aliases
@@ -503,22 +449,22 @@ static ssize_t pack_float128(PyObject *__obj, char *__dst, size_t __dst_len)
 
 static ssize_t pack_name(PyObject *__obj, char *__dst, size_t __dst_len)
 {
-    return pack_uint64(__obj, __dst, __dst_len);
+    return pack_name_like(__obj, __dst, __dst_len, JITABI_KIND_NAME);
 }
 
 static ssize_t pack_account_name(PyObject *__obj, char *__dst, size_t __dst_len)
 {
-    return pack_uint64(__obj, __dst, __dst_len);
+    return pack_name_like(__obj, __dst, __dst_len, JITABI_KIND_NAME);
 }
 
 static ssize_t pack_symbol(PyObject *__obj, char *__dst, size_t __dst_len)
 {
-    return pack_uint64(__obj, __dst, __dst_len);
+    return pack_name_like(__obj, __dst, __dst_len, JITABI_KIND_SYMBOL);
 }
 
 static ssize_t pack_symbol_code(PyObject *__obj, char *__dst, size_t __dst_len)
 {
-    return pack_uint64(__obj, __dst, __dst_len);
+    return pack_name_like(__obj, __dst, __dst_len, JITABI_KIND_SYMBOL_CODE);
 }
 
 static ssize_t pack_checksum160(PyObject *__obj, char *__dst, size_t __dst_len)
@@ -0,0 +1,489 @@
+// columnar decoding
+//
+// `unpack_columns` decodes an array of structs into one column per field
+// instead of one dict per row. Plain nested struct fields are flattened into
+// dotted paths, the remaining fields become:
+//
+//   - ints, floats, names, times & varints: a memoryview over one contiguous
+//     buffer in native layout (the wire's little endian for fixed ones)
+//   - other fixed width types (checksums, keys, 128 bit ints): a 'B'
+//     memoryview of rows * size bytes
+//   - string & bytes: (offsets, data), int64 offsets with rows + 1 entries
+//     into one bytes object of concatenated values, like Arrow large binary
+//   - everything else (optionals, arrays, enums...): a list of values
+//
+// rows are walked with the skip functions, so only list columns allocate
+// Python objects per row.
+
+// growable bytes object columns are written into, handed out as is
+struct col_buf {
+    PyObject *bytes;
+    size_t    len;
+};
+
+static int col_buf_reserve(struct col_buf *cb, size_t n)
+{
+    size_t cap = cb->bytes ? (size_t)PyBytes_GET_SIZE(cb->bytes) : 0;
+    if (cap - cb->len >= n)
+        return 0;
+
+    cap = cap ? cap : 64;
+    while (cap - cb->len < n) {
+        if (cap > PY_SSIZE_T_MAX / 2) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        cap *= 2;
+    }
+
+    if (!cb->bytes) {
+        cb->bytes = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)cap);
+        return cb->bytes ? 0 : -1;
+    }
+    return _PyBytes_Resize(&cb->bytes, (Py_ssize_t)cap);
+}
+
+static JITABI_INLINE int col_buf_put(struct col_buf *cb, const void *src, size_t n)
+{
+    if (!cb->bytes || (size_t)PyBytes_GET_SIZE(cb->bytes) - cb->len < n) {
+        if (col_buf_reserve(cb, n) < 0)
+            return -1;
+    }
+
+    // constant sizes compile to single moves instead of a memcpy call
+    char *dst = PyBytes_AS_STRING(cb->bytes) + cb->len;
+    switch (n) {
+        case 1:  memcpy(dst, src, 1); break;
+        case 2:  memcpy(dst, src, 2); break;
+        case 4:  memcpy(dst, src, 4); break;
+        case 8:  memcpy(dst, src, 8); break;
+        default: memcpy(dst, src, n); break;
+    }
+    cb->len += n;
+    return 0;
+}
+
+// the filled part of `cb` as a bytes object, `cb` is left empty
+static PyObject *col_buf_finish(struct col_buf *cb)
+{
+    PyObject *ret = cb->bytes;
+    cb->bytes = NULL;
+
+    if (!ret)
+        return PyBytes_FromStringAndSize(NULL, 0);
+
+    if (_PyBytes_Resize(&ret, (Py_ssize_t)cb->len) < 0)
+        return NULL;
+    return ret;
+}
+
+struct column {
+    PyObject                *path;
+    const struct proj_field *field;
+    struct type_expr         expr;      // list columns
+    PyObject                *values;    // list columns
+    struct col_buf           data;
+    struct col_buf           offsets;   // string & bytes columns
+};
+
+struct col_plan {
+    Py_ssize_t        ncols;
+    struct column    *cols;
+    struct proj_node *root;
+};
+
+static void col_plan_free(struct col_plan *plan)
+{
+    for (Py_ssize_t i = 0; i < plan->ncols; i++) {
+        struct column *c = &plan->cols[i];
+        Py_XDECREF(c->path);
+        Py_XDECREF(c->values);
+        Py_XDECREF(c->data.bytes);
+        Py_XDECREF(c->offsets.bytes);
+    }
+    PyMem_Free(plan->cols);
+    proj_node_free(plan->root);
+}
+
+// `inner` is `outer` or one of its sub paths
+static bool path_covers(const char *outer, const char *inner)
+{
+    size_t n = strlen(outer);
+    return strncmp(outer, inner, n) == 0 && (inner[n] == '\0' || inner[n] == '.');
+}
+
+static int col_plan_add_column(
+    struct col_plan *plan,
+    struct proj_node *node,
+    Py_ssize_t index,
+    PyObject *path)
+{
+    const struct proj_field *f = &_PROJ_TYPES[node->type].fields[index];
+
+    struct column *cols = PyMem_Realloc(
+        plan->cols, (size_t)(plan->ncols + 1) * sizeof(struct column));
+    if (!cols) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    plan->cols = cols;
+
+    struct column *c = &cols[plan->ncols];
+    memset(c, 0, sizeof(*c));
+    c->field = f;
+
+    struct proj_step *s = proj_add_step(node, index);
+    if (!s)
+        return -1;
+    s->slot = plan->ncols;
+
+    // registered before anything else can fail so col_plan_free owns it
+    Py_INCREF(path);
+    c->path = path;
+    plan->ncols++;
+
+    if (f->col_kind == JITABI_COL_OBJECT) {
+        if (parse_type_expr(f->type_name, strlen(f->type_name), &c->expr) < 0)
+            return -1;
+
+        c->values = PyList_New(0);
+        if (!c->values)
+            return -1;
+    }
+
+    if (f->col_kind == JITABI_COL_BYTES) {
+        int64_t zero = 0;
+        if (col_buf_put(&c->offsets, &zero, sizeof(zero)) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * Add a column per leaf field under `node` (flattening plain nested structs)
+ * that is covered by one of `filters`, all of them when `filters` is NULL.
+ */
+static int col_plan_build(
+    struct col_plan *plan,
+    struct proj_node *node,
+    PyObject *prefix,
+    const char **filters,
+    bool *matched,
+    Py_ssize_t nfilters,
+    int depth)
+{
+    if (depth > JITABI_PROJ_MAX_DEPTH) {
+        PyErr_SetString(PyExc_ValueError, "struct nesting too deep");
+        return -1;
+    }
+
+    const struct proj_type *t = &_PROJ_TYPES[node->type];
+    for (Py_ssize_t i = 0; i < t->nfields; i++) {
+        const struct proj_field *f = &t->fields[i];
+
+        PyObject *path = prefix
+            ? PyUnicode_FromFormat("%U.%s", prefix, f->name)
+            : PyUnicode_FromString(f->name);
+        if (!path)
+            return -1;
+
+        const char *p = PyUnicode_AsUTF8(path);
+        if (!p) {
+            Py_DECREF(path);
+            return -1;
+        }
+
+        bool descend = f->type >= 0
+            && f->kind == JITABI_PROJ_PLAIN
+            && !_PROJ_TYPES[f->type].is_enum;
+
+        bool wanted = !filters;
+        for (Py_ssize_t j = 0; j < nfilters; j++) {
+            if (path_covers(filters[j], p)) {
+                wanted = true;
+                if (!descend)
+                    matched[j] = true;
+            }
+            else if (descend && path_covers(p, filters[j]))
+                wanted = true;
+        }
+
+        int rc = 0;
+        if (wanted && descend) {
+            struct proj_step *s = proj_add_step(node, i);
+            if (!s || !(s->node = proj_node_new(f->type)))
+                rc = -1;
+            else
+                rc = col_plan_build(
+                    plan, s->node, path, filters, matched, nfilters, depth + 1);
+        }
+        else if (wanted)
+            rc = col_plan_add_column(plan, node, i, path);
+
+        Py_DECREF(path);
+        if (rc < 0)
+            return -1;
+    }
+    return 0;
+}
+
+// decode one row at `b` into the columns, returns its size or -1
+static ssize_t col_exec(
+    struct col_plan *plan,
+    const struct proj_node *node,
+    const char *b,
+    size_t buf_len)
+{
+    const struct proj_type *t = &_PROJ_TYPES[node->type];
+
+    size_t offsets[JITABI_PROJ_MAX_FIELDS];
+    ssize_t size = t->skip_fields(b, buf_len, offsets);
+    if (size < 0) {
+        PyErr_Format(PyExc_ValueError, "truncated or invalid %s payload", t->name);
+        return -1;
+    }
+
+    for (Py_ssize_t i = 0; i < node->nsteps; i++) {
+        const struct proj_step *s = &node->steps[i];
+        const char *fb = b + offsets[s->index];
+        size_t flen = buf_len - offsets[s->index];
+
+        if (s->node) {
+            if (col_exec(plan, s->node, fb, flen) < 0)
+                return -1;
+            continue;
+        }
+
+        // skip_fields validated every field, reads below can't overrun
+        struct column *c = &plan->cols[s->slot];
+        int rc = 0;
+        switch (c->field->col_kind) {
+            case JITABI_COL_FIXED:
+                rc = col_buf_put(&c->data, fb, c->field->col_size);
+                break;
+
+            case JITABI_COL_VARUINT32: {
+                unsigned long long v;
+                read_varuint32(fb, flen, &v);
+                uint32_t u = (uint32_t)v;
+                rc = col_buf_put(&c->data, &u, sizeof(u));
+                break;
+            }
+            case JITABI_COL_VARINT32: {
+                long long v;
+                read_varint32(fb, flen, &v);
+                int32_t i = (int32_t)v;
+                rc = col_buf_put(&c->data, &i, sizeof(i));
+                break;
+            }
+            case JITABI_COL_BYTES: {
+                unsigned long long l;
+                ssize_t lc = read_varuint32(fb, flen, &l);
+                rc = col_buf_put(&c->data, fb + lc, (size_t)l);
+                if (rc == 0) {
+                    int64_t end = (int64_t)c->data.len;
+                    rc = col_buf_put(&c->offsets, &end, sizeof(end));
+                }
+                break;
+            }
+            default: {
+                size_t consumed = 0;
+                PyObject *v = unpack_type_expr(&c->expr, 0, fb, flen, &consumed);
+                if (!v)
+                    return -1;
+
+                rc = PyList_Append(c->values, v);
+                Py_DECREF(v);
+                break;
+            }
+        }
+        if (rc < 0)
+            return -1;
+    }
+    return size;
+}
+
+// memoryview over the contents of `cb`, cast to `format`
+static PyObject *col_view(struct col_buf *cb, const char *format)
+{
+    PyObject *raw = col_buf_finish(cb);
+    if (!raw)
+        return NULL;
+
+    PyObject *view = PyMemoryView_FromObject(raw);
+    Py_DECREF(raw);
+    if (!view)
+        return NULL;
+
+    PyObject *ret = PyObject_CallMethod(view, "cast", "s", format);
+    Py_DECREF(view);
+    return ret;
+}
+
+static PyObject *col_result(struct col_plan *plan)
+{
+    PyObject *ret = JITABI_NEW_DICT(plan->ncols);
+    if (!ret)
+        return NULL;
+
+    for (Py_ssize_t i = 0; i < plan->ncols; i++) {
+        struct column *c = &plan->cols[i];
+        const struct proj_field *f = c->field;
+
+        PyObject *value;
+        switch (f->col_kind) {
+            case JITABI_COL_OBJECT:
+                value = c->values;
+                Py_INCREF(value);
+                break;
+
+            case JITABI_COL_BYTES: {
+                PyObject *offsets = col_view(&c->offsets, "q");
+                PyObject *data = offsets ? col_buf_finish(&c->data) : NULL;
+                value = data ? PyTuple_Pack(2, offsets, data) : NULL;
+                Py_XDECREF(offsets);
+                Py_XDECREF(data);
+                break;
+            }
+            default:
+                value = col_view(&c->data, f->col_format);
+                break;
+        }
+
+        if (!value || PyDict_SetItem(ret, c->path, value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(ret);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    return ret;
+}
+
+static PyObject *
+unpack_columns(PyObject *type_name, PyObject *buffer, PyObject *fields)
+{
+    const char *tn = PyUnicode_Check(type_name) ? PyUnicode_AsUTF8(type_name) : NULL;
+    if (!tn) {
+        if (!PyErr_Occurred())
+            PyErr_SetString(PyExc_TypeError, "type name must be a str");
+        return NULL;
+    }
+
+    int type = proj_lookup(tn);
+    if (type < 0 || _PROJ_TYPES[type].is_enum) {
+        PyErr_Format(PyExc_ValueError, "type '%s' is not a struct", tn);
+        return NULL;
+    }
+
+    PyObject *paths = NULL;
+    const char **filters = NULL;
+    bool *matched = NULL;
+    Py_ssize_t nfilters = 0;
+    PyObject *ret = NULL;
+    struct col_plan plan = {0, NULL, NULL};
+
+    if (fields && fields != Py_None) {
+        paths = PySequence_Tuple(fields);
+        if (!paths)
+            return NULL;
+
+        nfilters = PyTuple_GET_SIZE(paths);
+        filters = PyMem_Calloc((size_t)(nfilters ? nfilters : 1), sizeof(const char *));
+        matched = PyMem_Calloc((size_t)(nfilters ? nfilters : 1), sizeof(bool));
+        if (!filters || !matched) {
+            PyErr_NoMemory();
+            goto done;
+        }
+
+        for (Py_ssize_t i = 0; i < nfilters; i++) {
+            PyObject *p = PyTuple_GET_ITEM(paths, i);
+            filters[i] = PyUnicode_Check(p) ? PyUnicode_AsUTF8(p) : NULL;
+            if (!filters[i]) {
+                if (!PyErr_Occurred())
+                    PyErr_SetString(PyExc_TypeError, "field paths must be str");
+                goto done;
+            }
+        }
+    }
+
+    plan.root = proj_node_new(type);
+    if (!plan.root
+        || col_plan_build(&plan, plan.root, NULL, filters, matched, nfilters, 0) < 0)
+        goto done;
+
+    for (Py_ssize_t i = 0; i < nfilters; i++) {
+        if (!matched[i]) {
+            PyErr_Format(PyExc_ValueError, "unknown field path '%s' on %s", filters[i], tn);
+            goto done;
+        }
+    }
+
+    struct unpack_input in;
+    if (acquire_input(buffer, &in) < 0)
+        goto done;
+
+    unsigned long long rows;
+    ssize_t pos = read_varuint32(in.buf, in.len, &rows);
+    if (pos < 0) {
+        release_input(&in);
+        PyErr_Format(PyExc_ValueError, "truncated or invalid %s[] payload", tn);
+        goto done;
+    }
+
+    // rows take at least a byte each unless they hold nothing to decode
+    size_t hint = rows < in.len - (size_t)pos ? (size_t)rows : in.len - (size_t)pos;
+    for (Py_ssize_t i = 0; i < plan.ncols; i++) {
+        struct column *c = &plan.cols[i];
+        int rc = 0;
+        if (c->field->col_kind == JITABI_COL_BYTES)
+            rc = col_buf_reserve(&c->offsets, hint * sizeof(int64_t));
+
+        else if (c->field->col_kind != JITABI_COL_OBJECT)
+            rc = col_buf_reserve(&c->data, hint * c->field->col_size);
+
+        if (rc < 0) {
+            release_input(&in);
+            goto done;
+        }
+    }
+
+    for (unsigned long long r = 0; r < rows; r++) {
+        ssize_t size = col_exec(&plan, plan.root, in.buf + pos, in.len - (size_t)pos);
+        // rows of empty structs fill nothing, other empty rows (missing
+        // extensions) can't bound a bogus row count
+        if (size == 0 && plan.ncols == 0)
+            break;
+
+        if (size < 0 || (size == 0 && rows > in.len)) {
+            release_input(&in);
+            if (size == 0)
+                PyErr_Format(PyExc_ValueError, "truncated or invalid %s[] payload", tn);
+            goto done;
+        }
+        pos += size;
+    }
+    release_input(&in);
+
+    ret = col_result(&plan);
+
+done:
+    col_plan_free(&plan);
+    PyMem_Free(filters);
+    PyMem_Free(matched);
+    Py_XDECREF(paths);
+    return ret;
+}
+
+static PyObject *
+py_unpack_columns(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *fields;
+    if (parse_fields_arg(
+            "usage: unpack_columns(type_name: str, buf: bytes-like, fields: list[str] | None = None)",
+            args, nargs, kwnames, &fields) < 0)
+        return NULL;
+
+    JITABI_ENTER(JITABI_MODULE_STATE(self));
+    return JITABI_LEAVE(unpack_columns(args[0], args[1], fields));
+}
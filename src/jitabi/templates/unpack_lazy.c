@@ -0,0 +1,454 @@
+// lazy output mode
+//
+// structs decode to LazyStruct views: a skip pass validates the payload and
+// records where each field starts, fields are then decoded on first access
+// and cached. Views keep a reference to a bytes object holding the payload,
+// the input itself when it is a bytes object (zero copy), otherwise a copy
+// of the struct span.
+
+struct lazy_field {
+    size_t    offset;
+    PyObject *value;
+};
+
+struct lazy_desc {
+    const char  *name;
+    Py_ssize_t   nfields;
+    const int   *keys;      // field name key indices, declaration order
+    PyObject  *(*decode)(Py_ssize_t i, const char *b, size_t buf_len);
+};
+
+typedef struct {
+    PyObject_VAR_HEAD
+    const struct lazy_desc *desc;
+    PyObject   *owner;      // bytes holding `buf`
+    const char *buf;
+    size_t      len;
+    PyObject   *variant;    // enum variant name when decoded as one
+    struct lazy_field fields[1];
+} LazyStruct;
+
+#define LazyStruct_Check(op) (Py_TYPE(op) == (PyTypeObject *)_STATE->lazy_struct_type)
+
+// interned name of field `i`
+#define LAZY_KEY(desc, i) (_STATE->keys[(desc)->keys[i]])
+
+// borrowed, bytes object the payload currently being decoded lies in (if
+// any), set by acquire_input and while decoding lazy fields. Per thread since
+// decoding can release the GIL (or run without one).
+static JITABI_THREAD_LOCAL PyObject *_LAZY_OWNER = NULL;
+
+// set by acquire_input, lets the first (outermost) lazy struct of a top level
+// call locate its fields with the GIL released. Nested structs walk a part of
+// the same input, so releasing for them would only add overhead.
+static JITABI_THREAD_LOCAL bool _LAZY_NOGIL = false;
+
+static PyObject *lazy_new(
+    const struct lazy_desc *desc,
+    const char *b,
+    size_t len,
+    const size_t *offsets)
+{
+    LazyStruct *self = PyObject_GC_NewVar(
+        LazyStruct, (PyTypeObject *)_STATE->lazy_struct_type, desc->nfields);
+    if (!self)
+        return NULL;
+
+    self->desc = desc;
+    self->variant = NULL;
+    self->len = len;
+    for (Py_ssize_t i = 0; i < desc->nfields; i++) {
+        self->fields[i].offset = offsets[i];
+        self->fields[i].value = NULL;
+    }
+
+    PyObject *owner = _LAZY_OWNER;
+    uintptr_t start = owner ? (uintptr_t)PyBytes_AS_STRING(owner) : 0;
+    if (owner
+        && (uintptr_t)b >= start
+        && (uintptr_t)b + len <= start + (size_t)PyBytes_GET_SIZE(owner)) {
+        Py_INCREF(owner);
+        self->owner = owner;
+        self->buf = b;
+    }
+    else {
+        self->owner = PyBytes_FromStringAndSize(b, (Py_ssize_t)len);
+        if (!self->owner) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->buf = PyBytes_AS_STRING(self->owner);
+    }
+
+    PyObject_GC_Track((PyObject *)self);
+    return (PyObject *)self;
+}
+
+static int lazy_set_variant(PyObject *obj, PyObject *name)
+{
+    if (!LazyStruct_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError, "enum variant didn't decode to a LazyStruct");
+        return -1;
+    }
+
+    Py_INCREF(name);
+    Py_XSETREF(((LazyStruct *)obj)->variant, name);
+    return 0;
+}
+
+static PyObject *lazy_get_locked(LazyStruct *self, Py_ssize_t i)
+{
+    struct lazy_field *f = &self->fields[i];
+    if (f->value) {
+        Py_INCREF(f->value);
+        return f->value;
+    }
+
+    PyObject *prev = _LAZY_OWNER;
+    _LAZY_OWNER = self->owner;
+    PyObject *v = self->desc->decode(i, self->buf + f->offset, self->len - f->offset);
+    _LAZY_OWNER = prev;
+    if (!v)
+        return NULL;
+
+    // decoding may have let another thread in which stored it first
+    if (!f->value)
+        f->value = v;
+    else
+        Py_DECREF(v);
+
+    Py_INCREF(f->value);
+    return f->value;
+}
+
+// decoded value of field `i`, new reference
+static PyObject *lazy_get(LazyStruct *self, Py_ssize_t i)
+{
+    PyObject *v;
+    JITABI_BEGIN_CRITICAL_SECTION(self);
+    v = lazy_get_locked(self, i);
+    JITABI_END_CRITICAL_SECTION();
+    return v;
+}
+
+// index of field `key`, -1 when missing, last match wins like on dicts
+static Py_ssize_t lazy_index(LazyStruct *self, PyObject *key)
+{
+    const struct lazy_desc *desc = self->desc;
+    Py_ssize_t n = desc->nfields;
+
+    for (Py_ssize_t i = n - 1; i >= 0; i--)
+        if (LAZY_KEY(desc, i) == key)
+            return i;
+
+    if (!PyUnicode_Check(key))
+        return -1;
+
+    for (Py_ssize_t i = n - 1; i >= 0; i--)
+        if (PyUnicode_Compare(LAZY_KEY(desc, i), key) == 0)
+            return i;
+
+    return -1;
+}
+
+static JITABI_INLINE bool lazy_is_type_key(LazyStruct *self, PyObject *key)
+{
+    return self->variant && (
+        key == __key_type
+        || (PyUnicode_Check(key) && PyUnicode_Compare(key, __key_type) == 0));
+}
+
+static PyObject *lazy_to_dict(LazyStruct *self);
+
+// deep copy of a decoded value with every LazyStruct replaced by its dict
+static PyObject *lazy_plain(PyObject *v)
+{
+    if (LazyStruct_Check(v))
+        return lazy_to_dict((LazyStruct *)v);
+
+    if (PyList_CheckExact(v)) {
+        Py_ssize_t n = PyList_GET_SIZE(v);
+        PyObject *list = PyList_New(n);
+        if (!list)
+            return NULL;
+
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *item = lazy_plain(PyList_GET_ITEM(v, i));
+            if (!item) {
+                Py_DECREF(list);
+                return NULL;
+            }
+            PyList_SET_ITEM(list, i, item);
+        }
+        return list;
+    }
+
+    Py_INCREF(v);
+    return v;
+}
+
+static PyObject *lazy_to_dict(LazyStruct *self)
+{
+    PyObject *dict = JITABI_NEW_DICT(self->desc->nfields + 1);
+    if (!dict)
+        return NULL;
+
+    for (Py_ssize_t i = 0; i < self->desc->nfields; i++) {
+        PyObject *v = lazy_get(self, i);
+        if (!v)
+            goto error;
+
+        PyObject *plain = lazy_plain(v);
+        Py_DECREF(v);
+        if (!plain)
+            goto error;
+
+        int rc = PyDict_SetItem(dict, LAZY_KEY(self->desc, i), plain);
+        Py_DECREF(plain);
+        if (rc < 0)
+            goto error;
+    }
+
+    if (self->variant && PyDict_SetItem(dict, __key_type, self->variant) < 0)
+        goto error;
+
+    return dict;
+
+error:
+    Py_DECREF(dict);
+    return NULL;
+}
+
+static PyObject *lazy_keys(LazyStruct *self, PyObject *Py_UNUSED(ignored))
+{
+    Py_ssize_t n = self->desc->nfields;
+    PyObject *keys = PyList_New(n + (self->variant ? 1 : 0));
+    if (!keys)
+        return NULL;
+
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *k = LAZY_KEY(self->desc, i);
+        Py_INCREF(k);
+        PyList_SET_ITEM(keys, i, k);
+    }
+
+    if (self->variant) {
+        Py_INCREF(__key_type);
+        PyList_SET_ITEM(keys, n, __key_type);
+    }
+    return keys;
+}
+
+// slots & methods below are entry points, see JITABI_ENTER
+
+static PyObject *LazyStruct_keys(LazyStruct *self, PyObject *Py_UNUSED(ignored))
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    return JITABI_LEAVE(lazy_keys(self, NULL));
+}
+
+static PyObject *LazyStruct_to_dict(LazyStruct *self, PyObject *Py_UNUSED(ignored))
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    return JITABI_LEAVE(lazy_to_dict(self));
+}
+
+static PyObject *lazy_subscript(LazyStruct *self, PyObject *key)
+{
+    if (lazy_is_type_key(self, key)) {
+        Py_INCREF(self->variant);
+        return self->variant;
+    }
+
+    Py_ssize_t i = lazy_index(self, key);
+    if (i < 0) {
+        PyErr_SetObject(PyExc_KeyError, key);
+        return NULL;
+    }
+    return lazy_get(self, i);
+}
+
+static PyObject *LazyStruct_subscript(LazyStruct *self, PyObject *key)
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    return JITABI_LEAVE(lazy_subscript(self, key));
+}
+
+static PyObject *
+LazyStruct_get(LazyStruct *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (nargs < 1 || nargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "usage: get(key, default=None)");
+        return NULL;
+    }
+
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    PyObject *key = args[0];
+    if (lazy_is_type_key(self, key) || lazy_index(self, key) >= 0)
+        return JITABI_LEAVE(lazy_subscript(self, key));
+
+    PyObject *dflt = nargs == 2 ? args[1] : Py_None;
+    Py_INCREF(dflt);
+    return JITABI_LEAVE(dflt);
+}
+
+static PyObject *LazyStruct_getattro(LazyStruct *self, PyObject *name)
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    Py_ssize_t i = lazy_index(self, name);
+    if (i >= 0)
+        return JITABI_LEAVE(lazy_get(self, i));
+
+    return JITABI_LEAVE(PyObject_GenericGetAttr((PyObject *)self, name));
+}
+
+static Py_ssize_t LazyStruct_length(LazyStruct *self)
+{
+    return self->desc->nfields + (self->variant ? 1 : 0);
+}
+
+static int LazyStruct_contains(LazyStruct *self, PyObject *key)
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    return JITABI_LEAVE_INT(lazy_is_type_key(self, key) || lazy_index(self, key) >= 0);
+}
+
+static PyObject *LazyStruct_iter(LazyStruct *self)
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    PyObject *keys = lazy_keys(self, NULL);
+    if (!keys)
+        return JITABI_LEAVE(NULL);
+
+    PyObject *it = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return JITABI_LEAVE(it);
+}
+
+static PyObject *LazyStruct_raw(LazyStruct *self, void *Py_UNUSED(closure))
+{
+    if (self->buf == PyBytes_AS_STRING(self->owner)
+        && self->len == (size_t)PyBytes_GET_SIZE(self->owner)) {
+        Py_INCREF(self->owner);
+        return self->owner;
+    }
+    return PyBytes_FromStringAndSize(self->buf, (Py_ssize_t)self->len);
+}
+
+static PyObject *LazyStruct_repr(LazyStruct *self)
+{
+    return PyUnicode_FromFormat(
+        "<{{ m_name }}.LazyStruct %s, %zu bytes>", self->desc->name, self->len);
+}
+
+static PyObject *lazy_richcompare(PyObject *a, PyObject *b, int op)
+{
+    if ((op != Py_EQ && op != Py_NE) || !LazyStruct_Check(a))
+        Py_RETURN_NOTIMPLEMENTED;
+
+    LazyStruct *self = (LazyStruct *)a;
+    int eq;
+    if (LazyStruct_Check(b)
+        && ((LazyStruct *)b)->desc == self->desc
+        && ((LazyStruct *)b)->variant == self->variant) {
+        LazyStruct *other = (LazyStruct *)b;
+        eq = self->len == other->len && memcmp(self->buf, other->buf, self->len) == 0;
+    }
+    else if (LazyStruct_Check(b) || PyDict_Check(b)) {
+        PyObject *da = lazy_to_dict(self);
+        if (!da)
+            return NULL;
+
+        PyObject *db = PyDict_Check(b) ? (Py_INCREF(b), b) : lazy_to_dict((LazyStruct *)b);
+        if (!db) {
+            Py_DECREF(da);
+            return NULL;
+        }
+
+        eq = PyObject_RichCompareBool(da, db, Py_EQ);
+        Py_DECREF(da);
+        Py_DECREF(db);
+        if (eq < 0)
+            return NULL;
+    }
+    else
+        Py_RETURN_NOTIMPLEMENTED;
+
+    if (op == Py_NE)
+        eq = !eq;
+
+    return PyBool_FromLong(eq);
+}
+
+static PyObject *LazyStruct_richcompare(PyObject *a, PyObject *b, int op)
+{
+    // reflected comparisons are called with the arguments swapped, `a` is
+    // always the view
+    JITABI_ENTER(JITABI_TYPE_STATE(a));
+    return JITABI_LEAVE(lazy_richcompare(a, b, op));
+}
+
+static int LazyStruct_traverse(LazyStruct *self, visitproc visit, void *arg)
+{
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->owner);
+    Py_VISIT(self->variant);
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++)
+        Py_VISIT(self->fields[i].value);
+    return 0;
+}
+
+static int LazyStruct_clear(LazyStruct *self)
+{
+    Py_CLEAR(self->variant);
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++)
+        Py_CLEAR(self->fields[i].value);
+    return 0;
+}
+
+static void LazyStruct_dealloc(LazyStruct *self)
+{
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    LazyStruct_clear(self);
+    Py_CLEAR(self->owner);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyMethodDef LazyStruct_methods[] = {
+    {"keys",    (PyCFunction)LazyStruct_keys,    METH_NOARGS,    "field names"},
+    {"get",     (PyCFunction)LazyStruct_get,    METH_FASTCALL,  "get(key, default=None)"},
+    {"to_dict", (PyCFunction)LazyStruct_to_dict, METH_NOARGS,    "decode every field, same result as the dict output mode"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef LazyStruct_getset[] = {
+    {"raw", (getter)LazyStruct_raw, NULL, "encoded struct bytes", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot LazyStruct_slots[] = {
+    {Py_tp_dealloc,     JITABI_SLOT_FN(LazyStruct_dealloc)},
+    {Py_tp_traverse,    JITABI_SLOT_FN(LazyStruct_traverse)},
+    {Py_tp_clear,       JITABI_SLOT_FN(LazyStruct_clear)},
+    {Py_tp_getattro,    JITABI_SLOT_FN(LazyStruct_getattro)},
+    {Py_tp_repr,        JITABI_SLOT_FN(LazyStruct_repr)},
+    {Py_tp_richcompare, JITABI_SLOT_FN(LazyStruct_richcompare)},
+    {Py_tp_iter,        JITABI_SLOT_FN(LazyStruct_iter)},
+    {Py_mp_subscript,   JITABI_SLOT_FN(LazyStruct_subscript)},
+    {Py_mp_length,      JITABI_SLOT_FN(LazyStruct_length)},
+    {Py_sq_contains,    JITABI_SLOT_FN(LazyStruct_contains)},
+    {Py_tp_methods,     LazyStruct_methods},
+    {Py_tp_getset,      LazyStruct_getset},
+    {Py_tp_doc,         (void *)"struct view decoding fields on first access"},
+    {0, NULL}
+};
+
+static PyType_Spec LazyStruct_spec = {
+    "{{ m_name }}.LazyStruct",
+    offsetof(LazyStruct, fields),
+    sizeof(struct lazy_field),
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    LazyStruct_slots
+};
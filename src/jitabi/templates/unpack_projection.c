@@ -0,0 +1,664 @@
+// field projections
+//
+// a projection decodes only the fields named by dotted paths ("act.account")
+// into a flat {path: value} dict. Paths are resolved once against the struct
+// & enum metadata below into a tree of steps, decoding walks that tree using
+// the skip functions to find field offsets so everything off the paths is
+// only scanned. Paths step through plain, optional & extension struct fields
+// and through every variant of an enum, missing values decode as None.
+
+enum proj_kind {
+    JITABI_PROJ_PLAIN,
+    JITABI_PROJ_OPTIONAL,
+    JITABI_PROJ_EXTENSION
+};
+
+// column a field decodes into with `unpack_columns`
+enum col_kind {
+    JITABI_COL_OBJECT,      // list of decoded values
+    JITABI_COL_FIXED,       // wire bytes copied as is
+    JITABI_COL_VARUINT32,
+    JITABI_COL_VARINT32,
+    JITABI_COL_BYTES        // offsets + data
+};
+
+struct proj_field {
+    const char *name;
+    const char *type_name;  // type expression leaves are decoded with
+    int         type;       // _PROJ_TYPES index to step into, -1 for leaves
+    uint8_t     kind;       // enum proj_kind
+    uint8_t     col_kind;   // enum col_kind
+    uint8_t     col_size;   // column item size
+    const char *col_format; // column buffer format
+};
+
+struct proj_type {
+    const char              *name;
+    bool                     is_enum;
+    Py_ssize_t               nfields;
+    const struct proj_field *fields;    // enums: one per variant
+    ssize_t (*skip_fields)(const char *, size_t, size_t *);
+};
+
+// structs: flattened fields (base fields first), enums: variants
+{% for t in projection.types %}
+static const struct proj_field __proj_fields_{{ t.name }}[] = {
+{%- for f in t.fields %}
+    {"{{ f.name }}", "{{ f.type_name }}", {{ f.type }}, {{ f.kind }}, {{ f.column[0] }}, {{ f.column[2] }}, "{{ f.column[1] }}"},
+{%- endfor %}
+    {NULL, NULL, -1, JITABI_PROJ_PLAIN, JITABI_COL_OBJECT, 0, ""}
+};
+{% endfor %}
+
+static const struct proj_type _PROJ_TYPES[] = {
+{%- for t in projection.types %}
+{%- if t.is_enum %}
+    {"{{ t.name }}", true, {{ t.fields|length }}, __proj_fields_{{ t.name }}, NULL},
+{%- else %}
+    {"{{ t.name }}", false, {{ t.fields|length }}, __proj_fields_{{ t.name }}, skip_fields_{{ t.name }}},
+{%- endif %}
+{%- endfor %}
+};
+
+static const struct {
+    const char *name;
+    int         type;
+} _PROJ_NAMES[] = {
+{%- for name, t in projection.names %}
+    {"{{ name }}", {{ t }}},
+{%- endfor %}
+};
+
+#define JITABI_PROJ_NAMES_COUNT (sizeof(_PROJ_NAMES) / sizeof(_PROJ_NAMES[0]))
+#define JITABI_PROJ_MAX_FIELDS {{ projection.max_fields }}
+#define JITABI_PROJ_MAX_DEPTH 64
+
+struct proj_step;
+
+struct proj_node {
+    int               type;
+    Py_ssize_t        nsteps;
+    struct proj_step *steps;
+};
+
+struct proj_step {
+    Py_ssize_t        index;    // field or variant index
+    Py_ssize_t        slot;     // output slot for leaves
+    struct type_expr  expr;     // leaves only
+    struct proj_node *node;     // NULL for leaves
+};
+
+static struct proj_node *proj_node_new(int type)
+{
+    struct proj_node *node = PyMem_Calloc(1, sizeof(struct proj_node));
+    if (!node) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    node->type = type;
+    return node;
+}
+
+static void proj_node_free(struct proj_node *node)
+{
+    if (!node)
+        return;
+
+    for (Py_ssize_t i = 0; i < node->nsteps; i++)
+        proj_node_free(node->steps[i].node);
+
+    PyMem_Free(node->steps);
+    PyMem_Free(node);
+}
+
+static struct proj_step *proj_add_step(struct proj_node *node, Py_ssize_t index)
+{
+    struct proj_step *steps = PyMem_Realloc(
+        node->steps, (size_t)(node->nsteps + 1) * sizeof(struct proj_step));
+    if (!steps) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    node->steps = steps;
+
+    struct proj_step *s = &steps[node->nsteps++];
+    memset(s, 0, sizeof(*s));
+    s->index = index;
+    s->slot = -1;
+    return s;
+}
+
+/*
+ * Add `path` (decoded into `slot`) under `node`, returns how many leaves it
+ * resolved to (0 when it names no field) or -1 with an exception set.
+ */
+static Py_ssize_t
+proj_insert(struct proj_node *node, const char *path, Py_ssize_t slot, int depth)
+{
+    if (depth > JITABI_PROJ_MAX_DEPTH) {
+        PyErr_SetString(PyExc_ValueError, "projection path too deep");
+        return -1;
+    }
+
+    const struct proj_type *t = &_PROJ_TYPES[node->type];
+    Py_ssize_t matched = 0;
+
+    if (t->is_enum) {
+        // the path continues on every variant that has it
+        for (Py_ssize_t v = 0; v < t->nfields; v++) {
+            const struct proj_field *var = &t->fields[v];
+            if (var->type < 0)
+                continue;
+
+            struct proj_node *child = NULL;
+            for (Py_ssize_t i = 0; i < node->nsteps && !child; i++)
+                if (node->steps[i].index == v)
+                    child = node->steps[i].node;
+
+            bool created = !child;
+            if (created) {
+                struct proj_step *s = proj_add_step(node, v);
+                if (!s || !(s->node = proj_node_new(var->type)))
+                    return -1;
+                child = s->node;
+            }
+
+            Py_ssize_t m = proj_insert(child, path, slot, depth + 1);
+            if (m < 0)
+                return -1;
+
+            if (created && !m) {
+                proj_node_free(child);
+                node->nsteps--;
+            }
+            matched += m;
+        }
+        return matched;
+    }
+
+    const char *dot = strchr(path, '.');
+    size_t seg_len = dot ? (size_t)(dot - path) : strlen(path);
+
+    // last match wins like on decoded dicts
+    Py_ssize_t index = -1;
+    for (Py_ssize_t i = t->nfields - 1; i >= 0 && index < 0; i--)
+        if (strlen(t->fields[i].name) == seg_len
+            && memcmp(t->fields[i].name, path, seg_len) == 0)
+            index = i;
+
+    if (index < 0)
+        return 0;
+
+    const struct proj_field *f = &t->fields[index];
+    if (!dot) {
+        struct proj_step *s = proj_add_step(node, index);
+        if (!s)
+            return -1;
+
+        s->slot = slot;
+        if (parse_type_expr(f->type_name, strlen(f->type_name), &s->expr) < 0)
+            return -1;
+        return 1;
+    }
+
+    if (f->type < 0)
+        return 0;
+
+    struct proj_node *child = NULL;
+    for (Py_ssize_t i = 0; i < node->nsteps && !child; i++)
+        if (node->steps[i].index == index)
+            child = node->steps[i].node;
+
+    bool created = !child;
+    if (created) {
+        struct proj_step *s = proj_add_step(node, index);
+        if (!s || !(s->node = proj_node_new(f->type)))
+            return -1;
+        child = s->node;
+    }
+
+    matched = proj_insert(child, dot + 1, slot, depth + 1);
+    if (created && matched == 0) {
+        proj_node_free(child);
+        node->nsteps--;
+    }
+    return matched;
+}
+
+// _PROJ_TYPES index of a struct, enum or plain alias name, -1 if unknown
+static int proj_lookup(const char *tn)
+{
+    for (size_t i = 0; i < JITABI_PROJ_NAMES_COUNT; i++)
+        if (strcmp(_PROJ_NAMES[i].name, tn) == 0)
+            return _PROJ_NAMES[i].type;
+
+    return -1;
+}
+
+/*
+ * Resolve `fields` (iterable of dotted paths) against `type_name`, on success
+ * `*root` owns the step tree and `*paths` is a tuple with one str per slot.
+ */
+static int proj_compile(
+    PyObject *type_name,
+    PyObject *fields,
+    struct proj_node **root,
+    PyObject **paths)
+{
+    const char *tn = PyUnicode_Check(type_name) ? PyUnicode_AsUTF8(type_name) : NULL;
+    if (!tn) {
+        if (!PyErr_Occurred())
+            PyErr_SetString(PyExc_TypeError, "type name must be a str");
+        return -1;
+    }
+
+    int type = proj_lookup(tn);
+    if (type < 0) {
+        PyErr_Format(PyExc_ValueError, "type '%s' is not a struct or enum", tn);
+        return -1;
+    }
+
+    *paths = PySequence_Tuple(fields);
+    if (!*paths)
+        return -1;
+
+    *root = proj_node_new(type);
+    if (!*root)
+        goto error;
+
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(*paths); i++) {
+        PyObject *p = PyTuple_GET_ITEM(*paths, i);
+        const char *path = PyUnicode_Check(p) ? PyUnicode_AsUTF8(p) : NULL;
+        if (!path) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_TypeError, "field paths must be str");
+            goto error;
+        }
+
+        Py_ssize_t m = proj_insert(*root, path, i, 0);
+        if (m < 0)
+            goto error;
+
+        if (m == 0) {
+            PyErr_Format(PyExc_ValueError, "unknown field path '%s' on %s", path, tn);
+            goto error;
+        }
+    }
+    return 0;
+
+error:
+    proj_node_free(*root);
+    *root = NULL;
+    Py_CLEAR(*paths);
+    return -1;
+}
+
+static int proj_exec(
+    const struct proj_node *node,
+    const char *b,
+    size_t buf_len,
+    PyObject **values)
+{
+    const struct proj_type *t = &_PROJ_TYPES[node->type];
+
+    if (t->is_enum) {
+        unsigned long long tag;
+        ssize_t n = read_varuint32(b, buf_len, &tag);
+        if (n < 0 || tag >= (unsigned long long)t->nfields)
+            goto invalid;
+
+        for (Py_ssize_t i = 0; i < node->nsteps; i++)
+            if ((unsigned long long)node->steps[i].index == tag)
+                return proj_exec(
+                    node->steps[i].node, b + n, buf_len - (size_t)n, values);
+
+        return 0;
+    }
+
+    size_t offsets[JITABI_PROJ_MAX_FIELDS];
+    if (t->skip_fields(b, buf_len, offsets) < 0)
+        goto invalid;
+
+    for (Py_ssize_t i = 0; i < node->nsteps; i++) {
+        const struct proj_step *s = &node->steps[i];
+        const char *fb = b + offsets[s->index];
+        size_t flen = buf_len - offsets[s->index];
+
+        if (!s->node) {
+            size_t consumed = 0;
+            PyObject *v = unpack_type_expr(&s->expr, 0, fb, flen, &consumed);
+            if (!v)
+                return -1;
+
+            Py_XSETREF(values[s->slot], v);
+            continue;
+        }
+
+        // skip_fields validated the flag byte is there
+        if (t->fields[s->index].kind == JITABI_PROJ_OPTIONAL) {
+            if (!fb[0])
+                continue;
+            fb++;
+            flen--;
+        }
+        else if (t->fields[s->index].kind == JITABI_PROJ_EXTENSION && flen == 0)
+            continue;
+
+        if (proj_exec(s->node, fb, flen, values) < 0)
+            return -1;
+    }
+    return 0;
+
+invalid:
+    PyErr_Format(PyExc_ValueError, "truncated or invalid %s payload", t->name);
+    return -1;
+}
+
+// decode `buffer` through a compiled projection, returns the {path: value} dict
+static PyObject *proj_unpack(const struct proj_node *root, PyObject *paths, PyObject *buffer)
+{
+    Py_ssize_t n = PyTuple_GET_SIZE(paths);
+    PyObject **values = PyMem_Calloc((size_t)(n ? n : 1), sizeof(PyObject *));
+    if (!values)
+        return PyErr_NoMemory();
+
+    PyObject *ret = NULL;
+    struct unpack_input in;
+    if (acquire_input(buffer, &in) < 0)
+        goto done;
+
+    int rc = proj_exec(root, in.buf, in.len, values);
+    release_input(&in);
+    if (rc < 0)
+        goto done;
+
+    ret = JITABI_NEW_DICT(n);
+    if (!ret)
+        goto done;
+
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (PyDict_SetItem(ret, PyTuple_GET_ITEM(paths, i), values[i] ? values[i] : Py_None) < 0) {
+            Py_CLEAR(ret);
+            goto done;
+        }
+    }
+
+done:
+    for (Py_ssize_t i = 0; i < n; i++)
+        Py_XDECREF(values[i]);
+    PyMem_Free(values);
+    return ret;
+}
+
+// pre-resolved projections: mod.projection("action_trace", ["act.account"])
+
+typedef struct {
+    PyObject_HEAD
+    PyObject         *type_name;
+    PyObject         *paths;
+    struct proj_node *root;
+} Projection;
+
+// tracked so the module state's projection_cache can't keep the module alive
+static int Projection_traverse(Projection *self, visitproc visit, void *arg)
+{
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->type_name);
+    Py_VISIT(self->paths);
+    return 0;
+}
+
+static void Projection_dealloc(Projection *self)
+{
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->type_name);
+    Py_XDECREF(self->paths);
+    proj_node_free(self->root);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *Projection_repr(Projection *self)
+{
+    return PyUnicode_FromFormat("<Projection '%U' %R>", self->type_name, self->paths);
+}
+
+static PyObject *Projection_unpack(Projection *self, PyObject *arg)
+{
+    JITABI_ENTER(JITABI_TYPE_STATE(self));
+    return JITABI_LEAVE(proj_unpack(self->root, self->paths, arg));
+}
+
+static PyMethodDef Projection_methods[] = {
+    {"unpack", (PyCFunction)Projection_unpack, METH_O, "unpack(buf: bytes-like) -> dict[str, any]"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef Projection_members[] = {
+    {"type_name", T_OBJECT_EX, offsetof(Projection, type_name), READONLY, "projected type"},
+    {"fields",    T_OBJECT_EX, offsetof(Projection, paths),     READONLY, "projected field paths"},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyType_Slot Projection_slots[] = {
+    {Py_tp_dealloc,  JITABI_SLOT_FN(Projection_dealloc)},
+    {Py_tp_traverse, JITABI_SLOT_FN(Projection_traverse)},
+    {Py_tp_repr,     JITABI_SLOT_FN(Projection_repr)},
+    {Py_tp_methods,  Projection_methods},
+    {Py_tp_members,  Projection_members},
+    {Py_tp_doc,      (void *)"type decoder limited to a set of field paths"},
+    {0, NULL}
+};
+
+static PyType_Spec Projection_spec = {
+    "{{ m_name }}.Projection",
+    sizeof(Projection),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    Projection_slots
+};
+
+static PyObject *proj_new(struct module_state *st, PyObject *type_name, PyObject *fields)
+{
+    struct proj_node *root;
+    PyObject *paths;
+    if (proj_compile(type_name, fields, &root, &paths) < 0)
+        return NULL;
+
+    Projection *proj = PyObject_GC_New(Projection, (PyTypeObject *)st->projection_type);
+    if (!proj) {
+        proj_node_free(root);
+        Py_DECREF(paths);
+        return NULL;
+    }
+
+    Py_INCREF(type_name);
+    proj->type_name = type_name;
+    proj->paths = paths;
+    proj->root = root;
+    PyObject_GC_Track((PyObject *)proj);
+    return (PyObject *)proj;
+}
+
+static PyObject *
+py_projection(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (nargs != 2) {
+        PyErr_SetString(PyExc_TypeError,
+                        "usage: projection(type_name: str, fields: list[str])");
+        return NULL;
+    }
+
+    return proj_new(JITABI_MODULE_STATE(self), args[0], args[1]);
+}
+
+/*
+ * Projection behind `unpack(type_name, buf, fields=...)`, compiled once per
+ * (type name, field paths) and kept in the state's direct mapped
+ * `projection_cache`. Callers usually pass a fresh fields list every time,
+ * so slots are picked by hash & matched by value instead of identity.
+ */
+static PyObject *proj_cached(PyObject *type_name, PyObject *fields)
+{
+    struct module_state *st = _STATE;
+    PyObject *paths = PySequence_Tuple(fields);
+    if (!paths)
+        return NULL;
+
+    // unhashable paths aren't valid ones, let proj_compile report them
+    Py_hash_t th = PyObject_Hash(type_name);
+    Py_hash_t ph = th == -1 ? -1 : PyObject_Hash(paths);
+    if (ph == -1) {
+        PyErr_Clear();
+        PyObject *proj = proj_new(st, type_name, paths);
+        Py_DECREF(paths);
+        return proj;
+    }
+
+    PyObject **slot = &st->projection_cache[
+        (size_t)(th ^ ph) & (JITABI_PROJ_CACHE_SIZE - 1)
+    ];
+
+    // own a ref before comparing, __eq__ of a path may call back in & evict
+    JITABI_LOCK(st->projection_cache_lock);
+    PyObject *cached = *slot;
+    Py_XINCREF(cached);
+    JITABI_UNLOCK(st->projection_cache_lock);
+
+    if (cached) {
+        int eq = PyObject_RichCompareBool(((Projection *)cached)->type_name, type_name, Py_EQ);
+        if (eq > 0)
+            eq = PyObject_RichCompareBool(((Projection *)cached)->paths, paths, Py_EQ);
+
+        if (eq > 0) {
+            Py_DECREF(paths);
+            return cached;
+        }
+
+        Py_DECREF(cached);
+        if (eq < 0) {
+            Py_DECREF(paths);
+            return NULL;
+        }
+    }
+
+    PyObject *proj = proj_new(st, type_name, paths);
+    Py_DECREF(paths);
+    if (!proj)
+        return NULL;
+
+    Py_INCREF(proj);
+    JITABI_LOCK(st->projection_cache_lock);
+    PyObject *old = *slot;
+    *slot = proj;
+    JITABI_UNLOCK(st->projection_cache_lock);
+    Py_XDECREF(old);
+    return proj;
+}
+
+/*
+ * Where each field (flattened, base fields first) of the struct encoded at
+ * `offset` starts: [(name, type, offset), ...]. Fields can then be decoded
+ * on their own with `unpack_from(type, buf, offset)`, or with
+ * `array_offsets` for arrays.
+ */
+static PyObject *
+py_field_offsets(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (nargs != 2 && nargs != 3) {
+        PyErr_SetString(PyExc_TypeError,
+                        "usage: field_offsets(type_name: str, buf: bytes-like, offset: int = 0)");
+        return NULL;
+    }
+
+    const char *tn = PyUnicode_Check(args[0]) ? PyUnicode_AsUTF8(args[0]) : NULL;
+    if (!tn) {
+        if (!PyErr_Occurred())
+            PyErr_SetString(PyExc_TypeError, "type name must be a str");
+        return NULL;
+    }
+
+    int type = proj_lookup(tn);
+    if (type < 0 || _PROJ_TYPES[type].is_enum) {
+        PyErr_Format(PyExc_ValueError, "type '%s' is not a struct", tn);
+        return NULL;
+    }
+    const struct proj_type *t = &_PROJ_TYPES[type];
+
+    Py_ssize_t offset = 0;
+    if (nargs == 3) {
+        offset = PyNumber_AsSsize_t(args[2], PyExc_OverflowError);
+        if (offset == -1 && PyErr_Occurred())
+            return NULL;
+    }
+
+    struct unpack_input in;
+    if (acquire_input(args[1], &in) < 0)
+        return NULL;
+
+    if (offset < 0 || (size_t)offset > in.len) {
+        PyErr_Format(PyExc_ValueError,
+                     "offset %zd out of range for buffer of size %zu",
+                     offset, in.len);
+        release_input(&in);
+        return NULL;
+    }
+
+    size_t offsets[JITABI_PROJ_MAX_FIELDS];
+    ssize_t size;
+    JITABI_BEGIN_NOGIL(in.len - (size_t)offset)
+    size = t->skip_fields(in.buf + offset, in.len - (size_t)offset, offsets);
+    JITABI_END_NOGIL()
+    release_input(&in);
+
+    if (size < 0) {
+        PyErr_SetString(PyExc_ValueError, "truncated or invalid payload");
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(t->nfields);
+    if (!list)
+        return NULL;
+
+    for (Py_ssize_t i = 0; i < t->nfields; i++) {
+        PyObject *item = Py_BuildValue(
+            "(ssn)", t->fields[i].name, t->fields[i].type_name,
+            offset + (Py_ssize_t)offsets[i]);
+        if (!item) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);  // steal ref
+    }
+
+    return list;
+}
+
+/*
+ * Arguments of entry points taking (type_name, buf, fields=None), `fields`
+ * either positional or by keyword. `*fields` is borrowed, NULL when omitted.
+ */
+static int parse_fields_arg(
+    const char *usage,
+    PyObject *const *args,
+    Py_ssize_t nargs,
+    PyObject *kwnames,
+    PyObject **fields)
+{
+    Py_ssize_t nkw = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    *fields = nargs == 3 ? args[2] : NULL;
+
+    if (nkw == 1 && nargs == 2
+        && PyUnicode_CompareWithASCIIString(PyTuple_GET_ITEM(kwnames, 0), "fields") == 0)
+        *fields = args[2];
+
+    else if (nkw || (nargs != 2 && nargs != 3)) {
+        PyErr_SetString(PyExc_TypeError, usage);
+        return -1;
+    }
+
+    if (*fields == Py_None)
+        *fields = NULL;
+    return 0;
+}
@@ -28,121 +28,130 @@ static JITABI_INLINE uint64_t read_le64(const char *p) {
 #endif
 }
 
-static JITABI_INLINE PyObject *uint128_from_halves(uint64_t hi, uint64_t lo)
+// varints prefix every array, string, bytes & enum index. Reads are bounds
+// checked and take at most 5 bytes, they return the encoded size or -1 when
+// the buffer is truncated or the varint runs longer.
+//
+// Single byte varints (the vast majority) take a fast path. With 8 readable
+// bytes the whole varint is loaded at once: the lowest byte with a clear
+// high bit terminates it and the 7 bit groups are gathered with pext (BMI2
+// builds) or a fixed set of shifts & masks, no per byte branches. Shorter
+// tails fall back to a byte loop.
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_ARM64))
+
+#include <intrin.h>
+#define JITABI_WIDE_VARINT
+
+static JITABI_INLINE unsigned ctz64(uint64_t v)
 {
-    PyObject *py_hi  = PyLong_FromUnsignedLongLong(hi);
-    if (!py_hi) return NULL;
-
-    PyObject *shift  = PyLong_FromLong(64);
-    if (!shift) { Py_DECREF(py_hi); return NULL; }
-
-    PyObject *py_hi_shifted = PyNumber_Lshift(py_hi, shift);
-    Py_DECREF(py_hi); Py_DECREF(shift);
-    if (!py_hi_shifted) return NULL;
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (unsigned)i;
+}
 
-    PyObject *py_lo  = PyLong_FromUnsignedLongLong(lo);
-    if (!py_lo) { Py_DECREF(py_hi_shifted); return NULL; }
+#elif defined(__GNUC__) || defined(__clang__)
 
-    PyObject *res = PyNumber_Add(py_hi_shifted, py_lo);
-    Py_DECREF(py_hi_shifted); Py_DECREF(py_lo);
-    return res;  // new ref or NULL
-}
+#define JITABI_WIDE_VARINT
 
-static JITABI_INLINE PyObject *int128_from_halves(uint64_t hi, uint64_t lo)
+static JITABI_INLINE unsigned ctz64(uint64_t v)
 {
-    // sign bit lives in the high half
-    const bool negative = (hi & 0x8000000000000000ULL) != 0;
-
-    if (!negative)  // fast path for non-negative numbers
-        return uint128_from_halves(hi, lo);
+    return (unsigned)__builtin_ctzll(v);
+}
 
-    // two’s complement -> magnitude
-    hi = ~hi; lo = ~lo;
-    lo += 1;
-    if (lo == 0)  // propagate carry
-        hi += 1;
+#endif
 
-    PyObject *mag = uint128_from_halves(hi, lo);
-    if (!mag) return NULL;
-    PyObject *neg = PyNumber_Negative(mag);
-    Py_DECREF(mag);
-    return neg;  // new ref or NULL
-}
+#if defined(JITABI_WIDE_VARINT) && defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#define JITABI_PEXT_VARINT
+#endif
 
-static JITABI_INLINE unsigned long long decode_varuint32(const char *restrict p, size_t *consumed)
+static JITABI_INLINE ssize_t
+read_varuint32(const char *b, size_t buf_len, unsigned long long *v)
 {
-    const unsigned char *s = (const unsigned char *)p;
-    unsigned long long r = 0;
-    unsigned char b;
-    unsigned shift = 0;
-
-    /* first byte (-90 % of the time) */
-    b  = *s++;
-    r  =  b & 0x7F;
-    if (!(b & 0x80)) {
-        if (consumed) *consumed = 1;
-        return r;
+    if (buf_len > 0 && !(b[0] & 0x80)) {
+        *v = (unsigned char)b[0];
+        return 1;
     }
-    shift = 7;
 
-    /* remaining bytes (rare) */
-    while ( (b = *s++) & 0x80 ) {
-        r |= ((unsigned long long)(b & 0x7F)) << shift;
-        shift += 7;
-    }
-    r |= ((unsigned long long)b) << shift;
+#ifdef JITABI_WIDE_VARINT
+    if (buf_len >= 8) {
+        uint64_t w = read_le64(b);
 
-    if (consumed) *consumed = (size_t)(s - (const unsigned char *)p);
-    return r;
-}
+        // only the first 5 bytes may terminate it
+        uint64_t stops = ~w & 0x0000008080808080ULL;
+        if (!stops)
+            return -1;
 
-static JITABI_INLINE long long decode_varint32(const char *restrict p, size_t *consumed)
-{
-    const unsigned char *s = (const unsigned char *)p;
-    long long r = 0;
-    unsigned char b;
-    unsigned shift = 0;
+        unsigned n = ctz64(stops) / 8 + 1;
+        w &= ~0ULL >> (64 - 8 * n);
 
-    /* first byte fast-path */
-    b  = *s++;
-    r  =  b & 0x7F;
-    if (!(b & 0x80)) {
-        if (b & 0x40)   /* sign-extend negative single-byte values */
-            r |= -1LL << 7;
-        if (consumed) *consumed = 1;
-        return r;
+#ifdef JITABI_PEXT_VARINT
+        *v = _pext_u64(w, 0x0000007f7f7f7f7fULL);
+#else
+        *v = (w & 0x7f)
+           | ((w >> 1) & 0x3f80)
+           | ((w >> 2) & 0x1fc000)
+           | ((w >> 3) & 0xfe00000)
+           | ((w >> 4) & 0x7f0000000ULL);
+#endif
+        return (ssize_t)n;
     }
-    shift = 7;
+#endif
 
-    /* remaining bytes */
-    while ( (b = *s++) & 0x80 ) {
-        r |= ((long long)(b & 0x7F)) << shift;
-        shift += 7;
+    unsigned long long r = 0;
+    for (size_t i = 0; i < 5 && i < buf_len; i++) {
+        unsigned char byte = (unsigned char)b[i];
+        r |= (unsigned long long)(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80)) {
+            *v = r;
+            return (ssize_t)(i + 1);
+        }
     }
-    r |= ((long long)b & 0x7F) << shift;
+    return -1;
+}
+
+// signed LEB128, sign extended from the last group's high bit
+static JITABI_INLINE ssize_t
+read_varint32(const char *b, size_t buf_len, long long *v)
+{
+    unsigned long long r;
+    ssize_t n = read_varuint32(b, buf_len, &r);
+    if (n < 0)
+        return -1;
 
-    /* final sign-extension if negative */
-    if ((b & 0x40) && (shift + 7 < sizeof(long long) * 8))
-        r |= -1LL << (shift + 7);
+    unsigned bits = 7 * (unsigned)n;
+    if ((r >> (bits - 1)) & 1)
+        r |= ~0ULL << bits;
 
-    if (consumed) *consumed = (size_t)(s - (const unsigned char *)p);
-    return r;
+    *v = (long long)r;
+    return n;
 }
 
+// fail the current unpack_* call when fewer than `n` bytes remain
+#define JITABI_NEED_BYTES(n, type_str)                                   \
+    do {                                                                 \
+        if (buf_len < (n)) {                                             \
+            PyErr_SetString(PyExc_ValueError,                            \
+                            "buffer too small for " type_str);           \
+            return NULL;                                                 \
+        }                                                                \
+    } while (0)
+
 static JITABI_INLINE PyObject *unpack_bool (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 1;  return PyBool_FromLong(b[0] != 0); }
+{ JITABI_NEED_BYTES(1, "bool"); if (c) *c = 1;  return PyBool_FromLong(b[0] != 0); }
 
 static JITABI_INLINE PyObject *unpack_uint8 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 1;  return PyLong_FromUnsignedLong((unsigned char)b[0]); }
+{ JITABI_NEED_BYTES(1, "uint8"); if (c) *c = 1;  return PyLong_FromUnsignedLong((unsigned char)b[0]); }
 
 static JITABI_INLINE PyObject *unpack_uint16 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 2;  return PyLong_FromUnsignedLong(read_le16(b)); }
+{ JITABI_NEED_BYTES(2, "uint16"); if (c) *c = 2;  return PyLong_FromUnsignedLong(read_le16(b)); }
 
 static JITABI_INLINE PyObject *unpack_uint32 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 4;  return PyLong_FromUnsignedLong(read_le32(b)); }
+{ JITABI_NEED_BYTES(4, "uint32"); if (c) *c = 4;  return PyLong_FromUnsignedLong(read_le32(b)); }
 
 static JITABI_INLINE PyObject *unpack_uint64 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 8;  return PyLong_FromUnsignedLongLong(read_le64(b)); }
+{ JITABI_NEED_BYTES(8, "uint64"); if (c) *c = 8;  return PyLong_FromUnsignedLongLong(read_le64(b)); }
 
 static JITABI_INLINE PyObject *
 unpack_uint128(const char *b, size_t buf_len, size_t *c)
@@ -158,16 +167,16 @@ unpack_uint128(const char *b, size_t buf_len, size_t *c)
 }
 
 static JITABI_INLINE PyObject *unpack_int8 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 1;  return PyLong_FromLong((signed char)b[0]); }
+{ JITABI_NEED_BYTES(1, "int8"); if (c) *c = 1;  return PyLong_FromLong((signed char)b[0]); }
 
 static JITABI_INLINE PyObject *unpack_int16 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 2;  return PyLong_FromLong((int16_t)read_le16(b)); }
+{ JITABI_NEED_BYTES(2, "int16"); if (c) *c = 2;  return PyLong_FromLong((int16_t)read_le16(b)); }
 
 static JITABI_INLINE PyObject *unpack_int32 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 4;  return PyLong_FromLong((int32_t)read_le32(b)); }
+{ JITABI_NEED_BYTES(4, "int32"); if (c) *c = 4;  return PyLong_FromLong((int32_t)read_le32(b)); }
 
 static JITABI_INLINE PyObject *unpack_int64 (const char *b, size_t buf_len, size_t *c)
-{ if (c) *c = 8;  return PyLong_FromLongLong((int64_t)read_le64(b)); }
+{ JITABI_NEED_BYTES(8, "int64"); if (c) *c = 8;  return PyLong_FromLongLong((int64_t)read_le64(b)); }
 
 static JITABI_INLINE PyObject *
 unpack_int128(const char *b, size_t buf_len, size_t *c)
@@ -184,18 +193,33 @@ unpack_int128(const char *b, size_t buf_len, size_t *c)
 
 static JITABI_INLINE PyObject *unpack_varuint32 (const char *b, size_t buf_len, size_t *c)
 {
-    unsigned long long v = decode_varuint32(b, c);
+    unsigned long long v;
+    ssize_t n = read_varuint32(b, buf_len, &v);
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "truncated or invalid varuint32");
+        return NULL;
+    }
+
+    if (c) *c = (size_t)n;
     return PyLong_FromUnsignedLongLong(v);
 }
 
 static JITABI_INLINE PyObject *unpack_varint32 (const char *b, size_t buf_len, size_t *c)
 {
-    long long v = decode_varint32(b, c);
+    long long v;
+    ssize_t n = read_varint32(b, buf_len, &v);
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "truncated or invalid varint32");
+        return NULL;
+    }
+
+    if (c) *c = (size_t)n;
     return PyLong_FromLongLong(v);
 }
 
 static JITABI_INLINE PyObject *unpack_float32 (const char *b, size_t buf_len, size_t *c)
 {
+    JITABI_NEED_BYTES(4, "float32");
     if (c) *c = 4;
     float f;
     memcpy(&f, b, 4);
@@ -204,6 +228,7 @@ static JITABI_INLINE PyObject *unpack_float32 (const char *b, size_t buf_len, si
 
 static JITABI_INLINE PyObject *unpack_float64 (const char *b, size_t buf_len, size_t *c)
 {
+    JITABI_NEED_BYTES(8, "float64");
     if (c) *c = 8;
     double d;
     memcpy(&d, b, 8);
@@ -212,230 +237,211 @@ static JITABI_INLINE PyObject *unpack_float64 (const char *b, size_t buf_len, si
 
 static JITABI_INLINE PyObject *unpack_raw (const char *b, size_t len, size_t buf_len, size_t *c)
 {
+    JITABI_NEED_BYTES(len, "fixed size bytes");
     if (c) *c = len;
     return PyBytes_FromStringAndSize(b, len);
 }
 
 static JITABI_INLINE PyObject *unpack_bytes (const char *b, size_t buf_len, size_t *c)
 {
-    size_t len_consumed = 0;
-    unsigned long long l = decode_varuint32(b, &len_consumed);
+    unsigned long long l;
+    ssize_t len_consumed = read_varuint32(b, buf_len, &l);
 
-    JITABI_LOG_DEBUG("leb consumed: %lu", len_consumed);
+    JITABI_LOG_DEBUG("leb consumed: %zd", len_consumed);
     JITABI_LOG_DEBUG("about to unpack bytes of size: %llu", l);
 
-    if (l > PY_SSIZE_T_MAX ||
-        l > (unsigned long long)(buf_len - len_consumed)) {
+    if (len_consumed < 0 ||
+        l > (unsigned long long)(buf_len - (size_t)len_consumed)) {
         PyErr_SetString(PyExc_ValueError, "buffer too small for encoded length");
         return NULL;
     }
 
-    if (c) *c = len_consumed + (size_t)l;
+    if (c) *c = (size_t)len_consumed + (size_t)l;
     return PyBytes_FromStringAndSize(b + len_consumed, (Py_ssize_t)l);
 }
 
 static JITABI_INLINE PyObject *unpack_string (const char *b, size_t buf_len, size_t *c)
 {
-    size_t len_consumed = 0;
-    unsigned long long l = decode_varuint32(b, &len_consumed);
+    unsigned long long l;
+    ssize_t len_consumed = read_varuint32(b, buf_len, &l);
 
-    if (l > PY_SSIZE_T_MAX ||
-        l > (unsigned long long)(buf_len - len_consumed)) {
+    if (len_consumed < 0 ||
+        l > (unsigned long long)(buf_len - (size_t)len_consumed)) {
         PyErr_SetString(PyExc_ValueError, "buffer too small for encoded length");
         return NULL;
     }
 
-    if (c) *c = len_consumed + (size_t)l;
+    if (c) *c = (size_t)len_consumed + (size_t)l;
     return PyUnicode_DecodeUTF8(b + len_consumed, (Py_ssize_t)l, "strict");
 }
 
 
-// default structs
-
-static PyObject *unpack_asset(const char *b, size_t buf_len, size_t *c)
-{
-
-    size_t __consumed = 0;
-    size_t __total = 0;
-    #ifdef __JITABI_DEBUG
-    size_t __start_total = 0;
-    #endif
-
-    JITABI_LOG_DEBUG("UNPACK struct asset, buf_len: %lu", buf_len
-    );
-
+// skip_* functions validate and measure an encoded value without touching
+// the python API, they return the encoded size or -1 when the buffer is
+// truncated (callers raise)
 
-    // build python dict
-    PyObject *__dict = PyDict_New();
-    if (!__dict) goto error;
-
-    PyObject *____amount = NULL;
-    PyObject *____symbol = NULL;
-
-    // -------- field "amount": "int64" --------
-
-    JITABI_LOG_DEBUG(
-        "%s: %s",
-        "amount",
-        "int64"
-    );
-
-    ____amount = unpack_int64(
-        b + __total,
-        buf_len - __total,
-        &__consumed
-    );
-
-    if (!____amount) goto error;
-    __total += __consumed;
+#define DEF_SKIP_FIXED(type, n)                                           \
+    static JITABI_INLINE ssize_t skip_##type(const char *b, size_t buf_len) \
+    {                                                                     \
+        (void)b;                                                          \
+        return buf_len < (n) ? -1 : (ssize_t)(n);                         \
+    }
 
-    JITABI_LOG_DEBUG(
-        "amount start: %lu, size: %lu, total: %lu",
-        __start_total,
-        __total - __start_total,
-        __total
-    );
+DEF_SKIP_FIXED(bool, 1)
+DEF_SKIP_FIXED(uint8, 1)
+DEF_SKIP_FIXED(uint16, 2)
+DEF_SKIP_FIXED(uint32, 4)
+DEF_SKIP_FIXED(uint64, 8)
+DEF_SKIP_FIXED(uint128, 16)
+DEF_SKIP_FIXED(int8, 1)
+DEF_SKIP_FIXED(int16, 2)
+DEF_SKIP_FIXED(int32, 4)
+DEF_SKIP_FIXED(int64, 8)
+DEF_SKIP_FIXED(int128, 16)
+DEF_SKIP_FIXED(float32, 4)
+DEF_SKIP_FIXED(float64, 8)
+DEF_SKIP_FIXED(float128, 16)
+DEF_SKIP_FIXED(name, 8)
+DEF_SKIP_FIXED(account_name, 8)
+DEF_SKIP_FIXED(symbol, 8)
+DEF_SKIP_FIXED(symbol_code, 8)
+DEF_SKIP_FIXED(checksum160, 20)
+DEF_SKIP_FIXED(checksum256, 32)
+DEF_SKIP_FIXED(checksum512, 64)
+DEF_SKIP_FIXED(time_point, 8)
+DEF_SKIP_FIXED(time_point_sec, 4)
+DEF_SKIP_FIXED(block_timestamp_type, 4)
+DEF_SKIP_FIXED(public_key, 34)
+DEF_SKIP_FIXED(signature, 66)
+
+static JITABI_INLINE ssize_t skip_varuint32(const char *b, size_t buf_len)
+{
+    unsigned long long v;
+    return read_varuint32(b, buf_len, &v);
+}
 
-    // -------- field "symbol": "symbol" --------
+#define skip_varint32 skip_varuint32
 
-    JITABI_LOG_DEBUG(
-        "%s: %s",
-        "symbol",
-        "symbol"
-    );
+// string contents are only utf-8 validated when decoded
+static JITABI_INLINE ssize_t skip_bytes(const char *b, size_t buf_len)
+{
+    unsigned long long l;
+    ssize_t lc = read_varuint32(b, buf_len, &l);
+    if (lc < 0 || l > (unsigned long long)(buf_len - (size_t)lc))
+        return -1;
 
-    ____symbol = unpack_uint64(
-        b + __total,
-        buf_len - __total,
-        &__consumed
-    );
+    return lc + (ssize_t)l;
+}
 
-    if (!____symbol) goto error;
-    __total += __consumed;
+#define skip_string skip_bytes
 
-    JITABI_LOG_DEBUG(
-        "symbol start: %lu, size: %lu, total: %lu",
-        __start_total,
-        __total - __start_total,
-        __total
-    );
+static JITABI_INLINE PyObject *make_name_like(uint64_t v, enum name_kind kind)
+{
+#ifdef __JITABI_NAME_STRINGS
+    switch (kind) {
+        case JITABI_KIND_NAME:        return name_to_str(v);
+        case JITABI_KIND_SYMBOL:      return symbol_to_str(v);
+        case JITABI_KIND_SYMBOL_CODE: return symbol_code_to_str(v);
+    }
+#endif
+    (void)kind;
+    return PyLong_FromUnsignedLongLong(v);
+}
 
-    // -------- end of fields unpacking ---------
+// string decoding is where most of the cost goes, always cache it
+#if defined(__JITABI_NAME_STRINGS) && !defined(__JITABI_VALUE_CACHE)
+#define __JITABI_VALUE_CACHE
+#endif
 
-    // set total bytes consumed
-    if (c) *c = __total;
+#ifdef __JITABI_VALUE_CACHE
 
-    // set items
-    if (PyDict_SetItemString(__dict, "amount", ____amount) < 0) goto error;
-    if (PyDict_SetItemString(__dict, "symbol", ____symbol) < 0) goto error;
+// name-like uint64 values (name, account_name, symbol, symbol_code) repeat a
+// lot across a decode (same handful of contracts & actions), keep the last
+// object built for each slot of a direct mapped table and hand out new refs
+// to it on hits, ints <= 256 are already cached by CPython itself
+#ifndef JITABI_VALUE_CACHE_SIZE
+#define JITABI_VALUE_CACHE_SIZE 4096  // must be a power of two
+#endif
 
-    JITABI_LOG_DEBUG("fields set on dict");
+// JITABI_VALUE_CACHE_SIZE of them per module state
+struct value_cache_entry {
+    uint64_t  key;
+    int       kind;
+    PyObject *obj;
+};
 
-    // drop local refs now owned by dict
-    Py_DECREF(____amount);
-    Py_DECREF(____symbol);
-    return __dict;
+static JITABI_INLINE PyObject *cached_name_like(uint64_t v, enum name_kind kind)
+{
+#ifndef __JITABI_NAME_STRINGS
+    // all kinds decode to the same int
+    kind = JITABI_KIND_NAME;
+#endif
+    uint64_t h = (v + (uint64_t)kind) * 0x9E3779B97F4A7C15ULL;
+    struct module_state *st = _STATE;
+    struct value_cache_entry *e =
+        &st->value_cache[(size_t)(h >> 32) & (JITABI_VALUE_CACHE_SIZE - 1)];
+    JITABI_LOCK(st->value_cache_lock);
+    if (e->obj && e->key == v && e->kind == (int)kind) {
+        PyObject *hit = Py_NewRef(e->obj);
+        JITABI_UNLOCK(st->value_cache_lock);
+        return hit;
+    }
+    JITABI_UNLOCK(st->value_cache_lock);
 
-error:
-    PyErr_SetString(PyExc_RuntimeError, "While unpacking asset");
-    Py_XDECREF(____amount);
-    Py_XDECREF(____symbol);
-    Py_XDECREF(__dict);
-    return NULL;
+    PyObject *obj = make_name_like(v, kind);
+    if (!obj)
+        return NULL;
 
+    Py_INCREF(obj);
+    JITABI_LOCK(st->value_cache_lock);
+    PyObject *old = e->obj;
+    e->key = v;
+    e->kind = (int)kind;
+    e->obj = obj;
+    JITABI_UNLOCK(st->value_cache_lock);
+    Py_XDECREF(old);
+    return obj;
 }
 
-static PyObject *unpack_extended_asset(const char *b, size_t buf_len, size_t *c)
+static int init_value_cache(struct module_state *st)
 {
+    st->value_cache = PyMem_Calloc(
+        JITABI_VALUE_CACHE_SIZE, sizeof(struct value_cache_entry));
+    if (!st->value_cache) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
 
-    size_t __consumed = 0;
-    size_t __total = 0;
-    #ifdef __JITABI_DEBUG
-    size_t __start_total = 0;
-    #endif
-
-    JITABI_LOG_DEBUG("UNPACK struct extended_asset, buf_len: %lu", buf_len
-    );
-
-
-    // build python dict
-    PyObject *__dict = PyDict_New();
-    if (!__dict) goto error;
-
-    PyObject *____quantity = NULL;
-    PyObject *____contract = NULL;
-
-    // -------- field "quantity": "asset" --------
-
-    JITABI_LOG_DEBUG(
-        "%s: %s",
-        "quantity",
-        "asset"
-    );
-
-    ____quantity = unpack_asset(
-        b + __total,
-        buf_len - __total,
-        &__consumed
-    );
-
-    if (!____quantity) goto error;
-    __total += __consumed;
-
-    JITABI_LOG_DEBUG(
-        "quantity start: %lu, size: %lu, total: %lu",
-        __start_total,
-        __total - __start_total,
-        __total
-    );
-
-    // -------- field "contract": "name" --------
-
-    JITABI_LOG_DEBUG(
-        "%s: %s",
-        "contract",
-        "name"
-    );
-
-    ____contract = unpack_uint64(
-        b + __total,
-        buf_len - __total,
-        &__consumed
-    );
-
-    if (!____contract) goto error;
-    __total += __consumed;
-
-    JITABI_LOG_DEBUG(
-        "contract start: %lu, size: %lu, total: %lu",
-        __start_total,
-        __total - __start_total,
-        __total
-    );
-
-    // -------- end of fields unpacking ---------
+static void clear_value_cache(struct module_state *st)
+{
+    if (!st->value_cache)
+        return;
 
-    // set total bytes consumed
-    if (c) *c = __total;
+    for (size_t i = 0; i < JITABI_VALUE_CACHE_SIZE; i++)
+        Py_CLEAR(st->value_cache[i].obj);
+    PyMem_Free(st->value_cache);
+    st->value_cache = NULL;
+}
 
-    // set items
-    if (PyDict_SetItemString(__dict, "quantity", ____quantity) < 0) goto error;
-    if (PyDict_SetItemString(__dict, "contract", ____contract) < 0) goto error;
+#define JITABI_NAME_LIKE(v, kind) cached_name_like(v, kind)
 
-    JITABI_LOG_DEBUG("fields set on dict");
+#else
 
-    // drop local refs now owned by dict
-    Py_DECREF(____quantity);
-    Py_DECREF(____contract);
-    return __dict;
+#define JITABI_NAME_LIKE(v, kind) make_name_like(v, kind)
 
-error:
-    PyErr_SetString(PyExc_RuntimeError, "While unpacking extended_asset");
-    Py_XDECREF(____quantity);
-    Py_XDECREF(____contract);
-    Py_XDECREF(__dict);
-    return NULL;
+#endif
 
+static JITABI_INLINE PyObject *
+unpack_name_like(const char *b, size_t buf_len, size_t *c, enum name_kind kind)
+{
+    if (buf_len < 8) {
+        PyErr_SetString(PyExc_ValueError, "buffer too small for name");
+        return NULL;
+    }
+    if (c) *c = 8;
+    return JITABI_NAME_LIKE(read_le64(b), kind);
 }
 
 
@@ -450,29 +456,29 @@ static PyObject *unpack_float128(const char *__buf, size_t __buf_len, size_t *__
 
 static PyObject *unpack_name(const char *__buf, size_t __buf_len, size_t *__consumed)
 {
-    return unpack_uint64(
-        __buf, __buf_len, __consumed
+    return unpack_name_like(
+        __buf, __buf_len, __consumed, JITABI_KIND_NAME
     );
 }
 
 static PyObject *unpack_account_name(const char *__buf, size_t __buf_len, size_t *__consumed)
 {
-    return unpack_uint64(
-        __buf, __buf_len, __consumed
+    return unpack_name_like(
+        __buf, __buf_len, __consumed, JITABI_KIND_NAME
     );
 }
 
 static PyObject *unpack_symbol(const char *__buf, size_t __buf_len, size_t *__consumed)
 {
-    return unpack_uint64(
-        __buf, __buf_len, __consumed
+    return unpack_name_like(
+        __buf, __buf_len, __consumed, JITABI_KIND_SYMBOL
     );
 }
 
 static PyObject *unpack_symbol_code(const char *__buf, size_t __buf_len, size_t *__consumed)
 {
-    return unpack_uint64(
-        __buf, __buf_len, __consumed
+    return unpack_name_like(
+        __buf, __buf_len, __consumed, JITABI_KIND_SYMBOL_CODE
     );
 }
 
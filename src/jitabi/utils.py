@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 import os
+import platform
 import sysconfig
 import subprocess
 
@@ -88,3 +89,28 @@ def detect_compiler_type(cmd: str) -> str | None:
         if 'microsoft' in lower:
             return 'cl'
     return None
+
+
+def host_cpu_id() -> str:
+    '''
+    Identify the host cpu model and feature set, used to key modules built
+    with `-march=native` so a shared cache never serves them to a different
+    cpu.
+
+    '''
+    cpu = f'{platform.machine()} {platform.processor()}'
+
+    try:
+        with open('/proc/cpuinfo') as f:
+            info = f.read()
+
+    except OSError:
+        return cpu
+
+    # first core is enough, keep model & feature lines only
+    for line in info.split('\n\n', 1)[0].splitlines():
+        key, _, value = line.partition(':')
+        if key.strip() in ('model name', 'flags', 'Features', 'CPU part'):
+            cpu += f' {value.strip()}'
+
+    return cpu
@@ -176,6 +176,15 @@ def jit_ctx():
         ipc_locked=False
     )
 
+@pytest.fixture(scope='session')
+def jit_build_ctx():
+    '''
+    Writable context for tests needing modules built with non default params.
+
+    '''
+    return JITContext(cache_path=testing_cache_dir)
+
+
 @pytest.fixture
 def case_info(request, jit_ctx):
     '''
@@ -186,3 +195,14 @@ def case_info(request, jit_ctx):
     mod_name, abi, type_name = request.param
     key, module = jit_ctx.module_for_abi(mod_name, abi)
     return mod_name, abi, key, module, type_name
+
+
+@pytest.fixture
+def std_module(jit_ctx):
+    '''
+    Compiled `standard` ABI module, for tests exercising std types directly.
+
+    '''
+    (mod_name, abi), *_ = load_abis(whitelist=['standard'])
+    _, module = jit_ctx.module_for_abi(mod_name, abi)
+    return module
@@ -0,0 +1,80 @@
+import random
+import threading
+
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from jitabi import JITContext
+from jitabi._testing import load_abis
+
+
+(token_name, token_abi), *_ = load_abis(whitelist=['eosio_token'])
+
+
+def test_module_for_abi_async(tmp_path):
+    '''
+    Decodes go through the fallback while the module compiles, then through
+    the compiled module. A fresh context over the same cache gets the module
+    right away.
+
+    '''
+    value = token_abi.random_of('transfer', rng=random.Random(0))
+    raw = token_abi.pack('transfer', value)
+
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+    module = ctx.module_for_abi_async(token_name, token_abi)
+
+    token_abi.assert_deep_eq('transfer', value, module.unpack('transfer', raw))
+    token_abi.assert_deep_eq('transfer', value, module.unpack_transfer(raw))
+    assert module.pack_transfer(value) == raw
+
+    # only compiled modules have the batch & buffer entry points
+    for name in ('unpack_many', 'unpack_from', 'unpack_columns', 'pack_into'):
+        with pytest.raises(AttributeError):
+            getattr(module.fallback, name)
+
+    compiled = module.wait(timeout=300)
+    assert module.ready and module.module is compiled
+    token_abi.assert_deep_eq('transfer', value, module.unpack('transfer', raw))
+
+    ctx = JITContext(cache_path=tmp_path, readonly=True, ipc_locked=False)
+    module = ctx.module_for_abi_async(token_name, token_abi)
+    assert module.ready
+
+
+def test_module_for_abi_async_output(tmp_path):
+    '''
+    The fallback decodes to dicts, other output modes are refused instead
+    of switching value shapes once the compile lands.
+
+    '''
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+    for output in ('tuple', 'lazy'):
+        with pytest.raises(ValueError):
+            ctx.module_for_abi_async(
+                token_name, token_abi, params={'output': output})
+
+
+def test_module_for_abi_async_key(tmp_path):
+    '''
+    The background build uses the key computed at request time, even when
+    the name's version moves before the build thread picks it up.
+
+    '''
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+
+    # keep the single build thread busy until the version moved
+    gate = threading.Event()
+    ctx._executor = ThreadPoolExecutor(max_workers=1)
+    ctx._executor.submit(gate.wait)
+
+    module = ctx.module_for_abi_async(token_name, token_abi)
+    key = next(iter(ctx._pending))
+
+    ctx._inc_mod_name(token_name)
+    gate.set()
+
+    built_key, compiled = module.future.result(timeout=300)
+    assert built_key == key
+    assert module.wait() is compiled
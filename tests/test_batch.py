@@ -0,0 +1,138 @@
+import sys
+import logging
+
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+logger = logging.getLogger(__name__)
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'unpack-many-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms(), size=st.integers(min_value=0, max_value=8))
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_unpack_many(case_info, rng, size):
+    '''
+    All unpack_many input layouts must decode to the same values as calling
+    the direct unpack function once per payload.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    pack_fn = getattr(module, f'pack_{type_name}')
+
+    input_values = [
+        abi.random_of(type_name, rng=rng)
+        for _ in range(size)
+    ]
+    payloads = [pack_fn(v) for v in input_values]
+
+    # list of bytes
+    unpacked_seq = module.unpack_many(type_name, payloads)
+
+    # blob + offsets
+    offsets = [0]
+    for payload in payloads:
+        offsets.append(offsets[-1] + len(payload))
+
+    unpacked_offsets = module.unpack_many(
+        type_name, b''.join(payloads), offsets)
+
+    # length prefixed blob
+    framed = b''.join(module.pack('bytes', p) for p in payloads)
+    unpacked_framed = module.type(type_name).unpack_many(framed)
+
+    for unpacked in (unpacked_seq, unpacked_offsets, unpacked_framed):
+        assert len(unpacked) == size
+        for expected, value in zip(input_values, unpacked):
+            abi.assert_deep_eq(type_name, expected, value)
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_unpack_many_invalid(std_module):
+    module = std_module
+
+    blob = bytes(16)
+
+    for offsets in ([], [8, 0], [0, 17]):
+        with pytest.raises(ValueError):
+            module.unpack_many('uint64', blob, offsets)
+
+    with pytest.raises(TypeError):
+        module.unpack_many('uint64', [1, blob])
+
+    # non int bounds, also when there's no item to decode
+    for offsets in (['x'], [0, 'x'], ['x', 8]):
+        with pytest.raises(TypeError):
+            module.unpack_many('uint64', blob, offsets)
+
+    with pytest.raises(OverflowError):
+        module.unpack_many('uint64', blob, [2 ** 64])
+
+    # frame claims more bytes than available
+    with pytest.raises(ValueError):
+        module.unpack_many('uint64', b'\x10' + bytes(8))
+
+
+class _ClearsOnIndex:
+    '''
+    Offset that empties the list holding it when converted.
+
+    '''
+    def __init__(self, owner: list, value: int):
+        self.owner = owner
+        self.value = value
+
+    def __index__(self) -> int:
+        self.owner.clear()
+        return self.value
+
+
+def test_unpack_many_mutated(std_module):
+    '''
+    Offsets & buffers are read from a snapshot, converting an item can't
+    pull the rest of the list from under the decoder.
+
+    '''
+    blob = (1).to_bytes(8, 'little') + (2).to_bytes(8, 'little')
+
+    offsets: list = [0]
+    offsets += [_ClearsOnIndex(offsets, 8), 16]
+    assert std_module.unpack_many('uint64', blob, offsets) == [1, 2]
+    assert offsets == []
+
+    if sys.version_info < (3, 12):
+        return
+
+    class ClearsOnBuffer:
+        def __init__(self, owner: list):
+            self.owner = owner
+
+        def __buffer__(self, flags: int) -> memoryview:
+            self.owner.clear()
+            return memoryview(blob[:8])
+
+    buffers: list = []
+    buffers += [ClearsOnBuffer(buffers), blob[8:]]
+    assert std_module.unpack_many('uint64', buffers) == [1, 2]
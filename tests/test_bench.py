@@ -2,10 +2,12 @@ import os
 import pytest
 
 from jitabi import JITContext
+from jitabi.bench import MIXES, suite_cases
 from jitabi._testing import (
     inside_ci,
     testing_cache_dir,
     testing_abi_dir,
+    load_abis,
 )
 
 from antelope_rs import ABIView
@@ -36,11 +38,6 @@ _, std = jit.module_for_abi(
     'standard', stdabi,
 )
 
-_, std_no_inline = jit.module_for_abi(
-    'standard_noinline', stdabi,
-    params={'inlined': False},
-)
-
 
 # generate fat block
 input_fat_sample = stdabi.random_of(
@@ -130,3 +127,32 @@ def test_unpack_empty_block(benchmark, module):
 
     # sanity check
     stdabi.assert_deep_eq('signed_block', input_sample, unpacked)
+
+
+# system contract payload mixes, every output mode, direct vs dynamic vs
+# batch entry points & antelope_rs as baseline
+mix_cases = [
+    case
+    for name, abi in load_abis(whitelist=list(MIXES))
+    for case in suite_cases(jit, name, abi, MIXES[name], samples=64)
+]
+
+
+@pytest.mark.benchmark(
+    group='payload_mixes',
+    max_time=max_time,
+    disable_gc=True
+)
+@pytest.mark.parametrize(
+    'case',
+    mix_cases,
+    ids=[f'{c.type_name}-{c.mode}-{c.name}' for c in mix_cases]
+)
+def test_payload_mix(benchmark, case):
+    '''
+    Codec entry points over 64 random payloads of a system contract type.
+
+    '''
+    benchmark.extra_info['payloads'] = case.ops
+    benchmark.extra_info['bytes'] = case.nbytes
+    benchmark(case.run)
@@ -0,0 +1,65 @@
+import json
+
+from jitabi.bench import (
+    BASELINE,
+    measure,
+    suite_cases,
+    format_results,
+)
+from jitabi.__main__ import main
+from jitabi._testing import load_abis, testing_abi_dir, testing_cache_dir
+
+
+(token_name, token_abi), *_ = load_abis(whitelist=['eosio_token'])
+
+
+def test_suite_cases(jit_build_ctx):
+    '''
+    Every mode gets direct, dynamic & batch cases, antelope_rs runs the same
+    payloads.
+
+    '''
+    cases = suite_cases(
+        jit_build_ctx, token_name, token_abi, ['transfer'],
+        modes=('dict', 'tuple'),
+        samples=4
+    )
+    names = {(c.mode, c.name) for c in cases}
+    for mode in ('dict', 'tuple'):
+        for name in ('unpack_transfer', 'unpack', 'unpack_many', 'pack_transfer', 'pack'):
+            assert (mode, name) in names
+
+    assert {(BASELINE, 'unpack'), (BASELINE, 'pack')} <= names
+
+    results = [measure(c, min_time=0.001, repeat=2) for c in cases]
+    for r in results:
+        assert r.ns_per_op > 0 and r.bytes_per_s > 0
+        if r.name.startswith('unpack') and r.mode == 'dict':
+            # at least the dict itself
+            assert r.allocs_per_op >= 1
+
+    assert 'transfer' in format_results(results)
+
+
+def test_bench_cli(tmp_path, capsys):
+    '''
+    `jitabi bench` on captured payloads.
+
+    '''
+    raw = token_abi.pack('transfer', token_abi.random_of('transfer'))
+    capture = tmp_path / 'transfers.hex'
+    capture.write_text(f'{raw.hex()}\n{raw.hex()}\n')
+
+    assert main([
+        'bench', str(testing_abi_dir / f'{token_name}.json'),
+        '--type', 'transfer',
+        '--input', str(capture),
+        '--mode', 'dict',
+        '--cache', str(testing_cache_dir),
+        '--min-time', '0.001',
+        '--json'
+    ]) == 0
+
+    results = json.loads(capsys.readouterr().out)
+    assert {r['mode'] for r in results} == {'dict', BASELINE}
+    assert all(r['type_name'] == 'transfer' for r in results)
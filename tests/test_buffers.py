@@ -0,0 +1,99 @@
+import mmap
+import array
+import logging
+
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+logger = logging.getLogger(__name__)
+
+
+def _views_of(raw: bytes) -> dict:
+    padded = b'\x00' * 3 + raw + b'\x00' * 5
+    return {
+        'bytearray': bytearray(raw),
+        'memoryview': memoryview(raw),
+        'memoryview-slice': memoryview(padded)[3:3 + len(raw)],
+        'array': array.array('B', raw),
+    }
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'buffers-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_unpack_buffer_protocol(case_info, rng):
+    '''
+    Every unpack entry point must accept any C-contiguous buffer and decode
+    it exactly like the equivalent bytes object.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    input_value = abi.random_of(type_name, rng=rng)
+    raw = abi.pack(type_name, input_value)
+
+    unpack_fn = getattr(module, f'unpack_{type_name}')
+    codec = module.type(type_name)
+
+    views = _views_of(raw)
+    for kind, view in views.items():
+        abi.assert_deep_eq(type_name, input_value, unpack_fn(view))
+        abi.assert_deep_eq(type_name, input_value, module.unpack(type_name, view))
+        abi.assert_deep_eq(type_name, input_value, codec.unpack(view))
+
+    unpacked = codec.unpack_many(list(views.values()))
+    for value in unpacked:
+        abi.assert_deep_eq(type_name, input_value, value)
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_unpack_mmap(std_module, tmp_path):
+    raw = b'\x03\x01\x02\x03'
+    path = tmp_path / 'payload.bin'
+    path.write_bytes(raw)
+
+    with path.open('rb') as f:
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            assert std_module.unpack('uint8[]', mm) == [1, 2, 3]
+            assert std_module.unpack_many('uint8[]', mm, [0, len(raw)]) == [[1, 2, 3]]
+
+
+def test_unpack_releases_buffer(std_module):
+    buf = bytearray(b'\x01\x00\x00\x00')
+    assert std_module.unpack('uint32', buf) == 1
+
+    # resizing fails with BufferError while an export is still held
+    buf.extend(b'\x00')
+
+
+@pytest.mark.parametrize('value', ['abc', 5, None, [b'']])
+def test_unpack_non_buffer(std_module, value):
+    with pytest.raises(TypeError):
+        std_module.unpack('uint8[]', value)
+
+
+def test_unpack_non_contiguous(std_module):
+    with pytest.raises(BufferError):
+        std_module.unpack('uint8[]', memoryview(b'\x02\x00\x01\x00\x02\x00')[::2])
@@ -0,0 +1,78 @@
+import sys
+import json
+import random
+
+import pytest
+
+from jitabi.cache import ModuleParams
+from jitabi._testing import load_abis
+
+
+(std_name, std_abi), *_ = load_abis(whitelist=['standard'])
+
+
+def test_build_profile_params():
+    default = ModuleParams.default()
+    tuned = ModuleParams.from_dict({'opt_level': 3, 'lto': True})
+
+    assert default.is_default_profile()
+    assert not tuned.is_default_profile()
+    assert tuned.as_bytes() != default.as_bytes()
+    assert ModuleParams.from_dict(tuned.as_dict()) == tuned
+
+    for bad in ({'opt_level': 4}, {'opt_level': '3'}, {'pgo': 'maybe'}):
+        with pytest.raises(ValueError):
+            ModuleParams.from_dict(bad)
+
+
+def test_native_build(jit_build_ctx):
+    '''
+    A module built with every profile knob on decodes like the default one
+    and records the flags it was built with.
+
+    '''
+    key, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi,
+        params={'opt_level': 3, 'march_native': True, 'lto': True}
+    )
+
+    rng = random.Random(0)
+    for type_name in ('action_trace', 'signed_block', 'action'):
+        raw = std_abi.pack(type_name, std_abi.random_of(type_name, rng=rng))
+        assert module.pack(type_name, module.unpack(type_name, raw)) == raw
+
+    params = json.loads(
+        (jit_build_ctx.module_dir_for(key) / 'params.json').read_text()
+    )
+    assert params['opt_level'] == 3
+    assert 'compile' in params['flags'] and 'link' in params['flags']
+
+
+@pytest.mark.skipif(sys.platform == 'win32', reason='pgo needs gcc or clang')
+def test_pgo_build(jit_build_ctx):
+    '''
+    `pgo='use'` trains an instrumented twin of the module on the sample and
+    caches the optimized build under its own key.
+
+    '''
+    rng = random.Random(0)
+    sample = [
+        ('action_trace', std_abi.pack(
+            'action_trace', std_abi.random_of('action_trace', rng=rng)))
+        for _ in range(32)
+    ]
+
+    key, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi,
+        params={'pgo': 'use', 'opt_level': 3},
+        pgo_sample=sample
+    )
+    assert key.params.pgo == 'use'
+    assert not hasattr(module, '_pgo_dump')
+
+    for type_name, raw in sample:
+        assert module.pack(type_name, module.unpack(type_name, raw)) == raw
+
+    default_key, _ = jit_build_ctx.module_for_abi(std_name, std_abi)
+    assert key.src_hash != default_key.src_hash
+
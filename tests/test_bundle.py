@@ -0,0 +1,35 @@
+from jitabi import JITContext
+from jitabi.cache import Cache
+from jitabi.__main__ import main
+from jitabi._testing import load_abis, testing_abi_dir
+
+
+(token_name, token_abi), *_ = load_abis(whitelist=['eosio_token'])
+
+
+def test_build_bundle(tmp_path):
+    '''
+    `jitabi build` fills a cache that a readonly context serves from, the
+    cache only indexes entries until a module is requested.
+
+    '''
+    out = tmp_path / 'bundle'
+    assert main([
+        'build', str(testing_abi_dir / f'{token_name}.json'),
+        '--out', str(out), '--output', 'tuple'
+    ]) == 0
+
+    # built even when an earlier test already loaded a runtime
+    assert (out / '.runtime').is_dir()
+
+    cache = Cache(fs_location=out, ipc_locked=False)
+    entries = list(cache._cache.values())
+    assert len(entries) == 1
+    assert entries[0].source is None and entries[0].module is None
+
+    ctx = JITContext(cache_path=out, readonly=True, ipc_locked=False)
+    _, module = ctx.module_for_abi(
+        token_name, token_abi, params={'output': 'tuple'})
+
+    assert module.output == 'tuple'
+    assert module.__file__.startswith(str(out))
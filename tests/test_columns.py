@@ -0,0 +1,149 @@
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+def _get_path(row, path: str):
+    for key in path.split('.'):
+        row = row[key]
+
+    return row
+
+
+def _column_values(column, expected: list) -> list:
+    '''
+    Python values held by an `unpack_columns` column, `expected` tells fixed
+    width byte rows apart from uint8 columns.
+
+    '''
+    if isinstance(column, list):
+        return column
+
+    if isinstance(column, tuple):
+        offsets, data = column
+        values = [
+            data[offsets[i]:offsets[i + 1]]
+            for i in range(len(offsets) - 1)
+        ]
+        return [
+            v.decode('utf-8') if isinstance(e, str) else v
+            for v, e in zip(values, expected)
+        ]
+
+    assert isinstance(column, memoryview)
+    if expected and isinstance(expected[0], bytes):
+        raw = column.tobytes()
+        size = len(raw) // len(expected)
+        return [raw[i * size:(i + 1) * size] for i in range(len(expected))]
+
+    return column.tolist()
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'columns-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms(), size=st.integers(min_value=0, max_value=8))
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_unpack_columns(case_info, rng, size):
+    '''
+    Every column must hold the values the row by row decode of the same
+    array produced.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    if type_name in {v.name for v in abi.variants}:
+        with pytest.raises(ValueError):
+            module.unpack_columns(type_name, b'\x00')
+        return
+
+    raw = module.pack(f'{type_name}[]', [
+        abi.random_of(type_name, rng=rng)
+        for _ in range(size)
+    ])
+    rows = module.unpack(f'{type_name}[]', raw)
+    columns = module.unpack_columns(type_name, raw)
+
+    for path, column in columns.items():
+        expected = [_get_path(row, path) for row in rows]
+        assert _column_values(column, expected) == expected
+
+    if columns:
+        subset = list(columns)[:1]
+        assert list(module.unpack_columns(type_name, raw, fields=subset)) == subset
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_unpack_columns_layout(std_module):
+    actions = [
+        {
+            'account': 1,
+            'name': 2,
+            'authorization': [{'actor': 3, 'permission': 4}],
+            'data': b'\x01\x02'
+        },
+        {
+            'account': 5,
+            'name': 6,
+            'authorization': [],
+            'data': b''
+        },
+    ]
+    raw = std_module.pack('action[]', actions)
+
+    columns = std_module.unpack_columns('action', raw)
+    assert list(columns) == ['account', 'name', 'authorization', 'data']
+
+    assert columns['account'].format == 'Q'
+    assert columns['account'].tolist() == [1, 5]
+    assert columns['authorization'] == [[{'actor': 3, 'permission': 4}], []]
+
+    offsets, data = columns['data']
+    assert offsets.format == 'q'
+    assert offsets.tolist() == [0, 2, 2]
+    assert data == b'\x01\x02'
+
+    # nested plain structs flatten into dotted paths
+    perms = std_module.pack('permission_level_weight[]', [
+        {'permission': {'actor': 7, 'permission': 8}, 'weight': 1}
+    ])
+    assert list(std_module.unpack_columns(
+        'permission_level_weight', perms, fields=['permission']
+    )) == ['permission.actor', 'permission.permission']
+
+    columns = std_module.unpack_columns('permission_level_weight', perms)
+    assert list(columns) == ['permission.actor', 'permission.permission', 'weight']
+    assert columns['permission.actor'].tolist() == [7]
+    assert columns['weight'].format == 'H'
+
+    with pytest.raises(ValueError):
+        std_module.unpack_columns('action', raw[:-1])
+
+    for type_name, fields in (
+        ('action', ['missing']),
+        ('action', ['account.value']),
+        ('uint32', None),
+    ):
+        with pytest.raises(ValueError):
+            std_module.unpack_columns(type_name, raw, fields)
+
+    with pytest.raises(TypeError):
+        std_module.unpack_columns('action', raw, [1])
@@ -0,0 +1,133 @@
+import logging
+
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+logger = logging.getLogger(__name__)
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'dispatch-array-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms(), size=st.integers(min_value=0, max_value=4))
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_dispatch_array(case_info, rng, size):
+    '''
+    Dynamic dispatch of `<type>[]` must match packing each item with the
+    direct functions behind a varuint32 length prefix.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    case_name = f'{mod_name}:{type_name}[]'
+
+    input_value = [
+        abi.random_of(type_name, rng=rng)
+        for _ in range(size)
+    ]
+
+    pack_fn = getattr(module, f'pack_{type_name}')
+    expected = bytes([size]) + b''.join(pack_fn(v) for v in input_value)
+
+    # call twice, second one goes through the resolved type cache
+    for _ in range(2):
+        packed = module.pack(f'{type_name}[]', input_value)
+        assert packed == expected
+
+        unpacked = module.unpack(f'{type_name}[]', packed)
+        assert len(unpacked) == size
+        for expected_value, value in zip(input_value, unpacked):
+            abi.assert_deep_eq(type_name, expected_value, value)
+
+    event(case_name)
+
+
+@pytest.mark.parametrize(
+    'type_name,raw,expected',
+    [
+        ('bool', b'\x01', True),
+        ('uint32', b'\x01\x00\x00\x00', 1),
+        ('int8', b'\xff', -1),
+        ('name', (6138663577826885632).to_bytes(8, 'little'), 6138663577826885632),
+        ('string', b'\x05jitab', 'jitab'),
+        ('str', b'\x05jitab', 'jitab'),
+        ('checksum160', bytes(20), bytes(20)),
+        ('uint8[]', b'\x03\x01\x02\x03', [1, 2, 3]),
+    ]
+)
+def test_dispatch_std(std_module, type_name, raw, expected):
+    assert std_module.unpack(type_name, raw) == expected
+    assert std_module.pack(type_name, expected) == raw
+
+
+@pytest.mark.parametrize('type_name', ['', 'not_a_type', 'not_a_type[]', '[]'])
+def test_dispatch_unknown(std_module, type_name):
+    with pytest.raises(ValueError):
+        std_module.unpack(type_name, b'')
+
+    with pytest.raises(ValueError):
+        std_module.pack(type_name, None)
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'type-handle-{p[0]}:{p[2]}',
+)
+@pytest.mark.parametrize('modifiers', ['', '[]', '?', '[]?', '?[]', '[][]'])
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_type_handle(case_info, modifiers, rng):
+    '''
+    Pre-resolved `module.type(expr)` handles must agree with the reference
+    implementation for any modifier chain.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    type_expr = f'{type_name}{modifiers}'
+    codec = module.type(type_expr)
+
+    assert isinstance(codec, module.TypeCodec)
+    assert codec.name == type_expr
+
+    input_value = abi.random_of(type_expr, rng=rng)
+
+    packed = codec.pack(input_value)
+    assert packed == abi.pack(type_expr, input_value)
+    assert packed == module.pack(type_expr, input_value)
+
+    abi.assert_deep_eq(type_expr, input_value, codec.unpack(packed))
+    abi.assert_deep_eq(type_expr, input_value, module.unpack(type_expr, packed))
+
+    event(type_expr)
+
+
+@pytest.mark.parametrize('type_name', ['not_a_type', 'uint8[', '?', 'uint8' + '[]' * 9])
+def test_type_handle_invalid(std_module, type_name):
+    with pytest.raises(ValueError):
+        std_module.type(type_name)
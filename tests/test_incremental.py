@@ -0,0 +1,95 @@
+import json
+import random
+
+import pytest
+
+from antelope_rs import ABIView
+
+from jitabi import JITContext
+from jitabi.incremental import CompositeModule
+from jitabi._testing import load_abis, testing_abi_dir
+
+
+(token_name, token_abi), *_ = load_abis(whitelist=['eosio_token'])
+
+
+def test_incremental_rebuild(tmp_path):
+    '''
+    A new ABI version only compiles its changed types, unchanged ones keep
+    decoding through the module built for the previous version.
+
+    '''
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+    ctx.module_for_abi(token_name, token_abi)
+
+    definition = json.loads((testing_abi_dir / f'{token_name}.json').read_text())
+    for struct in definition['structs']:
+        if struct['name'] == 'transfer':
+            struct['fields'].append({'name': 'nonce', 'type': 'uint64'})
+
+    path = tmp_path / f'{token_name}.json'
+    path.write_text(json.dumps(definition))
+    abi = ABIView.from_file(path, cls=token_name)
+
+    # same context, the first build bumped the module's version suffix
+    key, module = ctx.module_for_abi(token_name, abi, incremental=True)
+
+    assert isinstance(module, CompositeModule)
+    assert module.delta_types == {'transfer'}
+
+    # composed once, handed out again on later requests
+    assert ctx.module_for_abi(token_name, abi, incremental=True) == (key, module)
+
+    # a fresh context finds the base module on disk
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+    _, fresh = ctx.module_for_abi(token_name, abi, incremental=True)
+    assert isinstance(fresh, CompositeModule)
+    assert fresh.delta_types == {'transfer'}
+
+    rng = random.Random(0)
+    for type_name in ('transfer', 'account', 'currency_stats'):
+        value = abi.random_of(type_name, rng=rng)
+        raw = abi.pack(type_name, value)
+
+        abi.assert_deep_eq(type_name, value, module.unpack(type_name, raw))
+        abi.assert_deep_eq(
+            type_name, value, getattr(module, f'unpack_{type_name}')(raw))
+        assert module.pack(type_name, value) == raw
+
+
+def test_incremental_removed_type(tmp_path):
+    '''
+    Types dropped from the ABI stay in the base module, the composite must
+    not serve them anymore.
+
+    '''
+    ctx = JITContext(cache_path=tmp_path, ipc_locked=False)
+    _, base = ctx.module_for_abi(token_name, token_abi)
+
+    definition = json.loads((testing_abi_dir / f'{token_name}.json').read_text())
+    definition['structs'] = [
+        s for s in definition['structs'] if s['name'] != 'close']
+    definition['actions'] = [
+        a for a in definition['actions'] if a['name'] != 'close']
+
+    path = tmp_path / f'{token_name}.json'
+    path.write_text(json.dumps(definition))
+    abi = ABIView.from_file(path, cls=token_name)
+
+    _, module = ctx.module_for_abi(token_name, abi, incremental=True)
+
+    assert isinstance(module, CompositeModule)
+    assert module.removed == {'close'}
+    assert 'close' in base.structs and 'close' not in module.structs
+
+    raw = token_abi.pack(
+        'close', token_abi.random_of('close', rng=random.Random(0)))
+    for type_expr in ('close', 'close[]'):
+        with pytest.raises(ValueError):
+            module.unpack(type_expr, raw)
+
+    with pytest.raises(AttributeError):
+        module.unpack_close
+
+    # std types still route to the base module
+    assert module.unpack('uint64', bytes(8)) == 0
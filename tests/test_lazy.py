@@ -0,0 +1,127 @@
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    load_abis,
+)
+
+
+(std_name, std_abi), *_ = load_abis(whitelist=['standard'])
+
+
+@pytest.fixture(scope='module')
+def lazy_module(jit_build_ctx):
+    '''
+    `standard` ABI module compiled with the lazy output mode.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi,
+        params={'output': 'lazy'}
+    )
+    return module
+
+
+def _plain(value):
+    if type(value).__name__ == 'LazyStruct':
+        return value.to_dict()
+
+    if isinstance(value, list):
+        return [_plain(v) for v in value]
+
+    return value
+
+
+@pytest.mark.parametrize(
+    'type_name',
+    [s.name for s in std_abi.structs + std_abi.variants]
+)
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_lazy_roundtrip(lazy_module, std_module, type_name, rng):
+    '''
+    Lazy views must expose the same values the dict output mode decodes, and
+    pack back to the exact same bytes, untouched or not.
+
+    '''
+    raw = std_abi.pack(type_name, std_abi.random_of(type_name, rng=rng))
+    expected = getattr(std_module, f'unpack_{type_name}')(raw)
+
+    value = getattr(lazy_module, f'unpack_{type_name}')(raw)
+    assert lazy_module.pack(type_name, value) == raw
+
+    if isinstance(value, lazy_module.LazyStruct):
+        assert len(value) == len(expected)
+        for key in value:
+            assert _plain(value[key]) == expected[key]
+
+    assert _plain(value) == expected
+    assert lazy_module.pack(type_name, value) == raw
+    assert lazy_module.pack(type_name, expected) == raw
+
+    # non bytes input gets copied
+    assert _plain(lazy_module.unpack(type_name, bytearray(raw))) == expected
+
+    event(f'lazy:{type_name}')
+
+
+def test_lazy_access(lazy_module):
+    raw = lazy_module.pack('action', {
+        'account': 1,
+        'name': 2,
+        'authorization': [{'actor': 3, 'permission': 4}],
+        'data': b'\x00'
+    })
+    action = lazy_module.unpack_action(raw)
+
+    # views share the input bytes
+    assert action.raw is raw
+    assert action.authorization[0].raw == raw[17:33]
+
+    assert action.account == 1 and action['name'] == 2
+    assert action.authorization is action.authorization
+    assert 'data' in action and 'type' not in action
+    assert action.get('missing', 5) == 5
+    assert list(action) == ['account', 'name', 'authorization', 'data']
+
+    with pytest.raises(KeyError):
+        action['missing']
+
+    with pytest.raises(AttributeError):
+        action.missing
+
+    assert action == lazy_module.unpack_action(bytearray(raw))
+    assert action == action.to_dict()
+
+    with pytest.raises(ValueError):
+        lazy_module.unpack_action(raw[:-1])
+
+
+def test_lazy_variant(lazy_module):
+    raw = b'\x00' + lazy_module.pack('action_receipt_v0', {
+        'receiver': 1,
+        'act_digest': bytes(32),
+        'global_sequence': 2,
+        'recv_sequence': 3,
+        'auth_sequence': [],
+        'code_sequence': 4,
+        'abi_sequence': 5
+    })
+
+    receipt = lazy_module.unpack_action_receipt(raw)
+    assert receipt['type'] == 'action_receipt_v0'
+    assert receipt.to_dict()['type'] == 'action_receipt_v0'
+    assert receipt.receiver == 1
+    assert receipt.raw == raw[1:]
+    assert lazy_module.pack_action_receipt(receipt) == raw
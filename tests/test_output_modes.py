@@ -0,0 +1,103 @@
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    load_abis,
+)
+
+
+(std_name, std_abi), *_ = load_abis(whitelist=['standard'])
+
+
+@pytest.fixture(scope='module', params=['tuple', 'structseq'])
+def seq_module(request, jit_build_ctx):
+    '''
+    `standard` ABI module compiled with a sequence output mode.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi,
+        params={'output': request.param}
+    )
+    return request.param, module
+
+
+@pytest.mark.parametrize(
+    'type_name',
+    [s.name for s in std_abi.structs + std_abi.variants]
+)
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_output_mode_roundtrip(seq_module, type_name, rng):
+    '''
+    Structs decode to tuples (or their struct sequence type) and encode
+    back to the exact same bytes.
+
+    '''
+    output, module = seq_module
+
+    raw = std_abi.pack(type_name, std_abi.random_of(type_name, rng=rng))
+    value = getattr(module, f'unpack_{type_name}')(raw)
+
+    if any(s.name == type_name for s in std_abi.structs):
+        if output == 'tuple':
+            assert type(value) is tuple
+
+        else:
+            assert type(value) is module.structs[type_name]
+
+    assert getattr(module, f'pack_{type_name}')(value) == raw
+    assert module.pack(type_name, value) == raw
+
+    event(f'{output}:{type_name}')
+
+
+def test_structseq_fields(seq_module):
+    output, module = seq_module
+    raw = std_abi.pack('permission_level', {'actor': 1, 'permission': 2})
+    value = module.unpack_permission_level(raw)
+
+    assert tuple(value) == (1, 2)
+    assert module.pack_permission_level((1, 2)) == raw
+
+    if output == 'structseq':
+        assert value.actor == 1 and value.permission == 2
+        assert type(value).__name__ == 'permission_level'
+
+        asset = module.unpack('asset', bytes(16))
+        assert (asset.amount, asset.symbol) == (0, 0)
+
+    with pytest.raises(TypeError):
+        module.pack_permission_level({'actor': 1, 'permission': 2})
+
+    with pytest.raises(TypeError):
+        module.pack_permission_level((1,))
+
+
+def test_enum_variant_pairs(seq_module):
+    output, module = seq_module
+    raw = b'\x00' + std_abi.pack('action_receipt_v0', {
+        'receiver': 1,
+        'act_digest': bytes(32),
+        'global_sequence': 2,
+        'recv_sequence': 3,
+        'auth_sequence': [],
+        'code_sequence': 4,
+        'abi_sequence': 5
+    })
+
+    name, receipt = module.unpack_action_receipt(raw)
+    assert name == 'action_receipt_v0'
+    assert tuple(receipt) == (1, bytes(32), 2, 3, [], 4, 5)
+    assert module.pack_action_receipt((name, receipt)) == raw
@@ -0,0 +1,245 @@
+import mmap
+
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+@pytest.mark.parametrize('size', [0, 100, 5000, 100_000, 9 * 1024 * 1024])
+def test_pack_grows_arena(std_module, size):
+    '''
+    Payloads larger than the pack scratch arena (and than its retained max)
+    must encode the same as small ones.
+
+    '''
+    data = bytes(size)
+    expected = std_module.pack('varuint32', size) + data
+
+    assert std_module.pack('bytes', data) == expected
+    assert std_module.type('bytes[]').pack([data, data]) == b'\x02' + expected * 2
+
+
+def test_pack_reentrant(std_module):
+    '''
+    Python code run from inside a pack (here `__index__`) may pack again
+    while the scratch arena and the outer resolved type are in use.
+
+    '''
+    class Index:
+        def __index__(self):
+            assert std_module.pack('bytes', bytes(10_000))[:3] == b'\x90\x4e\x00'
+
+            # fresh type name objects, churns the resolved type name cache
+            for i in range(128):
+                assert std_module.pack('uint' + str(8 * 2 ** (i % 4)), 0)
+
+            return 5
+
+    assert std_module.pack('int64[]', [Index(), 1]) == (
+        b'\x02' + (5).to_bytes(8, 'little') + (1).to_bytes(8, 'little')
+    )
+
+
+class _ClearsOnIndex:
+    '''
+    Int that empties the list holding it when packed.
+
+    '''
+    def __init__(self, owner: list, value: int):
+        self.owner = owner
+        self.value = value
+
+    def __index__(self) -> int:
+        self.owner.clear()
+        return self.value
+
+
+def test_pack_mutated_array(std_module):
+    '''
+    Arrays pack from a snapshot, python code run by an item can't pull the
+    rest of the list from under the encoder.
+
+    '''
+    expected = std_module.pack('int64[]', [1, 2, 3])
+
+    items: list = [1]
+    items += [_ClearsOnIndex(items, 2), 3]
+    assert std_module.pack('int64[]', items) == expected
+    assert items == []
+
+    # struct fields go through the generated array loops
+    trace = {
+        'action_ordinal': 1,
+        'creator_action_ordinal': 0,
+        'receipt': None,
+        'receiver': 1,
+        'act': {'account': 1, 'name': 2, 'authorization': [], 'data': b''},
+        'context_free': False,
+        'elapsed': 0,
+        'console': b'',
+        'account_ram_deltas': [{'account': 1, 'delta': 2}, {'account': 3, 'delta': 4}],
+        'except': None,
+        'error_code': None
+    }
+    expected = std_module.pack('action_trace_v0', trace)
+
+    deltas: list = [{'account': 1}, {'account': 3, 'delta': 4}]
+    deltas[0]['delta'] = _ClearsOnIndex(deltas, 2)
+    assert std_module.pack('action_trace_v0', dict(trace, account_ram_deltas=deltas)) == expected
+    assert deltas == []
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'pack-into-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms(), offset=st.integers(min_value=0, max_value=7))
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_pack_into(case_info, rng, offset):
+    '''
+    `pack_into` must write exactly what `pack` returns, at the requested
+    offset, and leave the rest of the destination untouched.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    input_value = abi.random_of(type_name, rng=rng)
+    expected = abi.pack(type_name, input_value)
+
+    for pack_into in (
+        lambda v, b, o: module.pack_into(type_name, v, b, o),
+        module.type(type_name).pack_into,
+    ):
+        out = bytearray(b'\xaa' * (offset + len(expected) + 2))
+        written = pack_into(input_value, out, offset)
+
+        assert written == len(expected)
+        assert out[offset:offset + written] == expected
+        assert out[:offset] == b'\xaa' * offset
+        assert out[offset + written:] == b'\xaa\xaa'
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_pack_into_targets(std_module):
+    view = memoryview(bytearray(16))
+    assert std_module.pack_into('uint32', 7, view[4:8]) == 4
+    assert view[4:8] == b'\x07\x00\x00\x00'
+
+    with mmap.mmap(-1, 8) as mm:
+        assert std_module.pack_into('string', 'abc', mm, 4) == 4
+        assert mm[4:8] == b'\x03abc'
+
+
+def test_pack_into_invalid(std_module):
+    out = bytearray(4)
+
+    with pytest.raises(ValueError):
+        std_module.pack_into('uint64', 1, out)
+
+    for offset in (-1, 5):
+        with pytest.raises(ValueError):
+            std_module.pack_into('uint8', 1, out, offset)
+
+    with pytest.raises(BufferError):
+        std_module.pack_into('uint8', 1, b'read only')
+
+    with pytest.raises(TypeError):
+        std_module.pack_into('uint8', 1, None)
+
+
+@pytest.mark.parametrize(
+    'type_name,items',
+    [
+        ('uint64[]', [0, 1, 0xffffffffffffffff]),
+        ('name[]', [0x5530ea033482a600, 0]),
+        ('checksum256[]', [bytes(32), b'\xff' * 32]),
+        ('permission_level[]', [{'actor': 1, 'permission': 2}] * 3),
+    ]
+)
+def test_fixed_size_arrays(std_module, type_name, items):
+    '''
+    Arrays of fixed size items are bounds checked once as a whole, both
+    from the top level dispatcher and from struct fields.
+
+    '''
+    raw = std_module.pack(type_name, items)
+    assert std_module.unpack(type_name, raw) == items
+    assert std_module.sizeof_packed(type_name, raw) == len(raw)
+
+    with pytest.raises(ValueError):
+        std_module.unpack(type_name, raw[:-1])
+
+    out = bytearray(len(raw) - 1)
+    with pytest.raises(ValueError):
+        std_module.pack_into(type_name, items, out)
+
+    auth = std_module.pack('action', {
+        'account': 1,
+        'name': 2,
+        'authorization': [{'actor': 3, 'permission': 4}] * 4,
+        'data': b''
+    })
+    assert std_module.unpack_action(auth)['authorization'][3] == {
+        'actor': 3, 'permission': 4
+    }
+    with pytest.raises(RuntimeError):
+        std_module.unpack_action(auth[:-2])
+
+
+def test_fixed_size_bytes_length(std_module):
+    for value in (bytes(31), bytes(33)):
+        with pytest.raises(ValueError):
+            std_module.pack('checksum256', value)
+
+        with pytest.raises(ValueError):
+            std_module.pack('checksum256[]', [bytes(32), value])
+
+
+def test_pack_sequence_inputs(std_module):
+    '''
+    Arrays pack from tuples exactly like from lists, struct dicts are
+    looked up through the interned field keys.
+
+    '''
+    action = {
+        'account': 1,
+        'name': 2,
+        'authorization': [{'actor': 3, 'permission': 4}] * 2,
+        'data': b'\x01'
+    }
+    raw = std_module.pack('action', action)
+
+    as_tuple = dict(action, authorization=tuple(action['authorization']))
+    assert std_module.pack('action', as_tuple) == raw
+    assert std_module.pack('action[]', (action, as_tuple)) == \
+        std_module.pack('action[]', [action, action])
+    assert std_module.pack('uint16[]', (1, 2)) == std_module.pack('uint16[]', [1, 2])
+
+    # keys built at runtime still hit the interned ones by value
+    assert std_module.pack('action', {''.join(k): v for k, v in action.items()}) == raw
+
+    with pytest.raises(KeyError):
+        std_module.pack('action', {k: v for k, v in action.items() if k != 'data'})
+
+    with pytest.raises(TypeError):
+        std_module.pack('action', [1, 2, [], b''])
+
+    with pytest.raises(TypeError):
+        std_module.pack('action', dict(action, authorization={'actor': 3}))
@@ -0,0 +1,86 @@
+import random
+
+import pytest
+
+from jitabi.parallel import unpack_array, unpack_struct
+from jitabi._testing import load_abis
+
+
+(std_name, std_abi), *_ = load_abis(whitelist=['standard'])
+
+
+@pytest.fixture(scope='module')
+def block_value():
+    return std_abi.random_of(
+        'signed_block',
+        rng=random.Random(0),
+        type_args={
+            'transaction_receipt[]': {
+                'min_list_size': 500,
+                'max_list_size': 500,
+            },
+        }
+    )
+
+
+def test_array_offsets(jit_build_ctx, block_value):
+    '''
+    `array_offsets` bounds split an array into its items, and feed straight
+    into `unpack_many`.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(std_name, std_abi)
+
+    receipts = block_value['transactions']
+    raw = b'\x00' * 3 + std_abi.pack('transaction_receipt[]', receipts)
+
+    bounds = module.array_offsets('transaction_receipt', raw, 3)
+    assert len(bounds) == len(receipts) + 1
+    assert bounds[-1] == len(raw)
+    for start, end, receipt in zip(bounds, bounds[1:], receipts):
+        assert raw[start:end] == std_abi.pack('transaction_receipt', receipt)
+
+    assert module.unpack_many('transaction_receipt', raw, bounds) == \
+        module.unpack('transaction_receipt[]', raw[3:])
+
+    with pytest.raises(ValueError):
+        module.array_offsets('transaction_receipt', raw[:-1], 3)
+
+    # empty items share a bound, a length prefix can't claim more of them
+    # than the input has bytes
+    assert module.array_offsets('get_status_request_v0', b'\x01') == [1, 1]
+
+    with pytest.raises(ValueError):
+        module.array_offsets('get_status_request_v0', b'\xff\xff\xff\xff\x0f')
+
+
+@pytest.mark.parametrize('output', ['dict', 'tuple'])
+def test_parallel_decode(jit_build_ctx, block_value, output):
+    '''
+    Chunked decodes stitch back into the same value a plain unpack returns.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi, params={'output': output})
+
+    raw = std_abi.pack('signed_block', block_value)
+    expected = module.unpack('signed_block', raw)
+
+    block = unpack_struct(
+        module, 'signed_block', raw, 'transactions',
+        min_items=1, workers=4, threads=True
+    )
+    assert block == expected
+
+    # under the threshold: one unpack_many call
+    block = unpack_struct(module, 'signed_block', raw, 'transactions')
+    assert block == expected
+
+    with pytest.raises(ValueError):
+        unpack_struct(module, 'signed_block', raw, 'producer_signature')
+
+    raw = std_abi.pack('transaction_receipt[]', block_value['transactions'])
+    assert unpack_array(
+        module, 'transaction_receipt', raw,
+        min_items=1, workers=3, threads=True
+    ) == module.unpack('transaction_receipt[]', raw)
@@ -0,0 +1,145 @@
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+def _paths(value, prefix=''):
+    '''
+    Yield every (dotted path, value) pair reachable through nested dicts.
+
+    '''
+    if not isinstance(value, dict):
+        return
+
+    for key, field in value.items():
+        if key == 'type':
+            continue
+
+        yield prefix + key, field
+        yield from _paths(field, f'{prefix}{key}.')
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'projection-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_projection(case_info, rng):
+    '''
+    Projecting every path of a decoded value must return the same values the
+    full decode produced.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    raw = abi.pack(type_name, abi.random_of(type_name, rng=rng))
+    expected = dict(_paths(module.unpack(type_name, raw)))
+    if not expected:
+        return
+
+    projection = module.projection(type_name, list(expected))
+    assert projection.fields == tuple(expected)
+    assert projection.unpack(raw) == expected
+    assert module.unpack(type_name, raw, fields=list(expected)) == expected
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_projection_paths(std_module):
+    raw = b'\x00' + std_module.pack('action_receipt_v0', {
+        'receiver': 1,
+        'act_digest': bytes(32),
+        'global_sequence': 2,
+        'recv_sequence': 3,
+        'auth_sequence': [],
+        'code_sequence': 4,
+        'abi_sequence': 5
+    })
+
+    # enums project through their variants
+    assert std_module.unpack('action_receipt', raw, ['receiver', 'abi_sequence']) == {
+        'receiver': 1, 'abi_sequence': 5
+    }
+
+    # unset optionals leave their paths as None
+    trace = std_module.projection('transaction_trace', ['except', 'partial.expiration'])
+    assert trace.type_name == 'transaction_trace'
+    raw = std_module.pack('transaction_trace', {
+        'type': 'transaction_trace_v0',
+        'id': bytes(32),
+        'status': 0,
+        'cpu_usage_us': 0,
+        'net_usage_words': 0,
+        'elapsed': 0,
+        'net_usage': 0,
+        'scheduled': False,
+        'action_traces': [],
+        'account_ram_delta': None,
+        'except': None,
+        'error_code': None,
+        'failed_dtrx_trace': None,
+        'partial': None
+    })
+    assert trace.unpack(raw) == {
+        'except': None, 'partial.expiration': None
+    }
+
+    with pytest.raises(ValueError):
+        trace.unpack(b'\x00')
+
+    for type_name, fields in (
+        ('action_receipt', ['missing']),
+        ('action_receipt', ['receiver.value']),
+        ('uint32', ['value']),
+    ):
+        with pytest.raises(ValueError):
+            std_module.projection(type_name, fields)
+
+    with pytest.raises(TypeError):
+        std_module.projection('action_receipt', [1])
+
+
+def test_projection_cached(std_module):
+    '''
+    `unpack(..., fields=...)` reuses compiled projections by value, a fresh
+    or mutated fields list decodes its own paths.
+
+    '''
+    raw = std_module.pack('permission_level', {'actor': 1, 'permission': 2})
+
+    fields = ['actor']
+    for _ in range(3):
+        assert std_module.unpack('permission_level', raw, fields=list(fields)) == {'actor': 1}
+
+    fields.append('permission')
+    assert std_module.unpack('permission_level', raw, fields=fields) == {
+        'actor': 1, 'permission': 2
+    }
+    assert std_module.unpack('permission_level', raw, fields=('permission',)) == {
+        'permission': 2
+    }
+
+    # invalid paths raise the same errors as uncached ones
+    with pytest.raises(ValueError):
+        std_module.unpack('permission_level', raw, fields=['missing'])
+
+    for fields in ([1], [['actor']]):
+        with pytest.raises(TypeError):
+            std_module.unpack('permission_level', raw, fields=fields)
@@ -0,0 +1,94 @@
+import sys
+import subprocess
+
+import pytest
+
+import jitabi
+
+from jitabi import JITContext
+from jitabi.cache import Cache
+from jitabi.runtime import RUNTIME_MODULE, runtime_dir
+
+
+def test_runtime_shared(jit_ctx, std_module):
+    '''
+    One runtime per process, generated modules bind the table it exports.
+
+    '''
+    rt = sys.modules[RUNTIME_MODULE]
+    assert jitabi._rt is rt
+    assert rt.version >= 1
+    assert type(rt.CAPI).__name__ == 'PyCapsule'
+
+    assert runtime_dir(jit_ctx._cache).is_dir()
+
+    # modules built against it decode through it
+    raw = (-2).to_bytes(16, 'little', signed=True)
+    assert std_module.unpack('int128', raw) == -2
+
+
+def test_runtime_not_indexed(tmp_path):
+    '''
+    The runtime dir isn't a module, the cache index skips it.
+
+    '''
+    JITContext(cache_path=tmp_path, ipc_locked=False)
+
+    assert (tmp_path / '.runtime').is_dir()
+    assert Cache(fs_location=tmp_path, ipc_locked=False)._cache == {}
+
+
+def test_runtime_required_first(std_module):
+    '''
+    A module's first import in the process needs the runtime `jitabi`
+    loaded, without it the import fails with an ImportError instead of
+    leaving the codecs unbound.
+
+    '''
+    code = f'''
+from importlib.machinery import ExtensionFileLoader
+from importlib.util import spec_from_file_location, module_from_spec
+
+loader = ExtensionFileLoader({std_module.__name__!r}, {std_module.__file__!r})
+spec = spec_from_file_location(
+    {std_module.__name__!r}, {std_module.__file__!r}, loader=loader)
+try:
+    loader.exec_module(module_from_spec(spec))
+
+except ImportError as e:
+    assert 'runtime' in str(e), e
+
+else:
+    raise AssertionError('imported without the runtime')
+'''
+    subprocess.run([sys.executable, '-c', code], check=True)
+
+
+@pytest.mark.parametrize(
+    'type_name,value',
+    [
+        ('uint128', 0),
+        ('uint128', 2 ** 128 - 1),
+        ('int128', -1),
+        ('int128', -2 ** 127),
+        ('int128', 2 ** 127 - 1),
+    ]
+)
+def test_int128_roundtrip(std_module, type_name, value):
+    raw = std_module.pack(type_name, value)
+    assert raw == value.to_bytes(16, 'little', signed=type_name == 'int128')
+    assert std_module.unpack(type_name, raw) == value
+
+
+@pytest.mark.parametrize(
+    'type_name,value',
+    [
+        ('uint128', -1),
+        ('uint128', 2 ** 128),
+        ('int128', 2 ** 127),
+        ('int128', -2 ** 127 - 1),
+    ]
+)
+def test_int128_out_of_range(std_module, type_name, value):
+    with pytest.raises(OverflowError):
+        std_module.pack(type_name, value)
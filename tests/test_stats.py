@@ -0,0 +1,95 @@
+import pytest
+
+from jitabi import stats_sample
+from jitabi.cache import ModuleParams
+from jitabi._testing import load_abis
+
+
+(token_name, token_abi), *_ = load_abis(whitelist=['eosio_token'])
+
+
+def test_stats_params():
+    default = ModuleParams.default()
+    counters = ModuleParams.from_dict({'stats': 'counters'})
+
+    assert default.stats == 'off'
+    assert counters.as_bytes() != default.as_bytes()
+    assert ModuleParams.from_dict(counters.as_dict()) == counters
+
+    with pytest.raises(ValueError):
+        ModuleParams.from_dict({'stats': 'maybe'})
+
+
+def test_stats_off(std_module):
+    assert not hasattr(std_module, 'stats')
+
+
+@pytest.mark.parametrize('mode', ['counters', 'timing'])
+def test_stats_counters(jit_build_ctx, mode):
+    '''
+    Top level values are counted per type & direction, arrays count their
+    items as objects, `stats(reset=True)` hands the counters over.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(
+        token_name, token_abi, params={'stats': mode})
+
+    assert (module.stats_clock != 'none') == (mode == 'timing')
+
+    module.stats(reset=True)
+    assert module.stats() == {'unpack': {}, 'pack': {}}
+
+    values = [token_abi.random_of('transfer') for _ in range(3)]
+    raws = [token_abi.pack('transfer', v) for v in values]
+
+    module.unpack_transfer(raws[0])
+    module.unpack_many('transfer', raws)
+    array = module.pack('transfer[]', values)
+    module.unpack('transfer[]', array)
+
+    with pytest.raises(RuntimeError):
+        module.unpack('transfer', raws[0][:3])
+
+    stats = module.stats()
+
+    # counted under the base type of the expression
+    transfer = stats['unpack']['transfer']
+    assert transfer['calls'] == 1 + len(raws) + 1 + 1
+    assert transfer['errors'] == 1
+    assert transfer['objects'] == 1 + len(raws) + len(values)
+    assert transfer['bytes'] == len(raws[0]) + sum(len(r) for r in raws) + len(array)
+
+    packed = stats['pack']['transfer']
+    assert packed['calls'] == 1 and packed['errors'] == 0
+    assert packed['objects'] == len(values)
+    assert packed['bytes'] == len(array)
+
+    if mode == 'timing':
+        assert transfer['ticks'] > 0
+    else:
+        assert 'ticks' not in transfer
+
+    assert module.stats(reset=True) == stats
+    assert module.stats() == {'unpack': {}, 'pack': {}}
+
+
+def test_stats_sample():
+    '''
+    Pgo samples follow the counted mix.
+
+    '''
+    stats = {
+        'unpack': {'transfer': {'calls': 9, 'ticks': 900}},
+        'pack': {'issue': {'calls': 1, 'ticks': 100}},
+    }
+    sample = stats_sample(token_abi, stats, size=200)
+
+    assert len(sample) == 200
+    counts = {t: sum(1 for n, _ in sample if n == t) for t in ('transfer', 'issue')}
+    assert counts['transfer'] + counts['issue'] == 200
+    assert counts['transfer'] > counts['issue']
+
+    for type_name, raw in sample[:8]:
+        token_abi.unpack(type_name, raw)
+
+    assert stats_sample(token_abi, {'unpack': {}, 'pack': {}}) == []
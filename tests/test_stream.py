@@ -0,0 +1,140 @@
+import logging
+
+import pytest
+from hypothesis import (
+    event,
+    given,
+    settings,
+    strategies as st,
+    HealthCheck
+)
+
+from jitabi._testing import (
+    default_test_deadline,
+    iter_type_meta,
+)
+
+
+logger = logging.getLogger(__name__)
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'stream-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms(), size=st.integers(min_value=0, max_value=4))
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_stream(case_info, rng, size):
+    '''
+    Walking back to back payloads with `unpack_from` and `iter_unpack` must
+    yield the same values as decoding each one on its own.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    input_values = [
+        abi.random_of(type_name, rng=rng)
+        for _ in range(size)
+    ]
+    payloads = [abi.pack(type_name, v) for v in input_values]
+    blob = b''.join(payloads)
+
+    offset = 0
+    for expected, payload in zip(input_values, payloads):
+        value, new_offset = module.unpack_from(type_name, blob, offset)
+        assert new_offset == offset + len(payload)
+        abi.assert_deep_eq(type_name, expected, value)
+        offset = new_offset
+
+    assert offset == len(blob)
+
+    # empty structs consume no bytes and can't be iterated over
+    if all(payloads):
+        it = module.type(type_name).iter_unpack(blob)
+        unpacked = list(it)
+        assert it.offset == len(blob)
+        assert len(unpacked) == size
+        for expected, value in zip(input_values, unpacked):
+            abi.assert_deep_eq(type_name, expected, value)
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_stream_truncated(std_module):
+    it = std_module.iter_unpack('uint32', bytes(6))
+    assert next(it) == 0
+
+    with pytest.raises(ValueError):
+        next(it)
+
+    assert it.offset == 4
+
+
+def test_stream_releases_buffer(std_module):
+    buf = bytearray(8)
+    it = std_module.iter_unpack('uint32', buf)
+    next(it)
+
+    with pytest.raises(BufferError):
+        buf.extend(b'\x00')
+
+    assert list(it) == [0]
+    buf.extend(b'\x00')
+
+
+@pytest.mark.parametrize('offset', [-1, 3])
+def test_unpack_from_invalid_offset(std_module, offset):
+    with pytest.raises(ValueError):
+        std_module.unpack_from('uint8', b'\x00\x01', offset)
+
+
+@pytest.mark.parametrize(
+    'case_info',
+    iter_type_meta(),
+    indirect=True,
+    ids=lambda p: f'sizeof-packed-{p[0]}:{p[2]}',
+)
+@given(rng=st.randoms())
+@settings(
+    max_examples=1,
+    deadline=default_test_deadline,
+    suppress_health_check=[HealthCheck.function_scoped_fixture],
+)
+def test_sizeof_packed(case_info, rng):
+    '''
+    `sizeof_packed` must measure exactly the bytes `unpack_from` consumes
+    without decoding anything.
+
+    '''
+    mod_name, abi, _, module, type_name = case_info
+
+    raw = abi.pack(type_name, abi.random_of(type_name, rng=rng))
+    _, consumed = module.unpack_from(type_name, raw)
+
+    assert module.sizeof_packed(type_name, raw) == consumed == len(raw)
+    assert module.type(type_name).sizeof_packed(memoryview(raw)) == len(raw)
+
+    event(f'{mod_name}:{type_name}')
+
+
+def test_sizeof_packed_invalid(std_module):
+    level = bytes(16)
+    assert std_module.sizeof_packed('permission_level[]', b'\x02' + level * 2 + b'\x00') == 33
+    assert std_module.sizeof_packed('asset', bytes(20)) == 16
+    assert std_module.sizeof_packed('string?', b'\x00') == 1
+
+    for type_name, raw in (
+        ('permission_level[]', b'\x03' + level * 2),
+        ('permission_level', level[:-1]),
+        ('bytes', b'\x05abc'),
+        ('varuint32', b'\xff' * 6),
+        ('string?', b''),
+    ):
+        with pytest.raises(ValueError):
+            std_module.sizeof_packed(type_name, raw)
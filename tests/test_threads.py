@@ -0,0 +1,146 @@
+import random
+
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from jitabi._testing import load_abis
+
+
+(std_name, std_abi), *_ = load_abis(whitelist=['standard'])
+
+
+@pytest.fixture(scope='module')
+def fat_block():
+    '''
+    `signed_block` big enough for the GIL free phase to kick in.
+
+    '''
+    value = std_abi.random_of(
+        'signed_block',
+        rng=random.Random(0),
+        type_args={
+            'transaction_receipt[]': {
+                'min_list_size': 2_000,
+                'max_list_size': 2_000,
+            },
+        }
+    )
+    raw = std_abi.pack('signed_block', value)
+    assert len(raw) >= 64 * 1024
+    return raw
+
+
+@pytest.mark.parametrize('output', ['dict', 'lazy'])
+def test_concurrent_decode(jit_build_ctx, fat_block, output):
+    '''
+    Decoding, measuring and packing from many threads at once, shared
+    caches (dispatch, pack arena, lazy owner) must not leak state between
+    threads.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(
+        std_name, std_abi,
+        params={'output': output, 'value_cache': True}
+    )
+
+    def plain(value):
+        return value.to_dict() if output == 'lazy' else value
+
+    expected = plain(module.unpack_signed_block(fat_block))
+
+    def work(i: int):
+        view = memoryview(fat_block) if i % 2 else fat_block
+        value = module.unpack('signed_block', view)
+        assert module.sizeof_packed('signed_block', view) == len(fat_block)
+        assert plain(value) == expected
+        assert module.pack_signed_block(value) == fat_block
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        list(pool.map(work, range(16)))
+
+
+def test_concurrent_mutation(jit_build_ctx):
+    '''
+    Lists mutated by other threads while being packed or used as
+    `unpack_many` inputs, every call must see some consistent snapshot.
+
+    '''
+    _, module = jit_build_ctx.module_for_abi(std_name, std_abi)
+
+    item = (7).to_bytes(8, 'little')
+    ints = [7] * 64
+    buffers = [item] * 64
+    offsets = list(range(0, 8 * 65, 8))
+    blob = item * 66
+
+    def mutate():
+        # single writer, offsets stay ascending & inside the blob
+        for _ in range(2_000):
+            ints.append(7)
+            buffers.append(item)
+            offsets.append(offsets[-1] + 8)
+            ints.pop()
+            buffers.pop()
+            offsets.pop()
+
+    def work(i: int):
+        for _ in range(500):
+            assert set(module.unpack('int64[]', module.pack('int64[]', ints))) == {7}
+            assert set(module.unpack_many('uint64', buffers)) == {7}
+            assert set(module.unpack_many('uint64', blob, offsets)) == {7}
+
+    with ThreadPoolExecutor(max_workers=5) as pool:
+        futs = [pool.submit(mutate)]
+        futs += [pool.submit(work, i) for i in range(4)]
+        for fut in futs:
+            fut.result()
+
+
+def test_subinterpreter(jit_build_ctx):
+    '''
+    Modules keep their state per module object, so an isolated subinterpreter
+    (own GIL) can import the same extension next to the main one.
+
+    '''
+    interpreters = None
+    for name in ('_interpreters', '_xxsubinterpreters'):
+        try:
+            interpreters = __import__(name)
+            break
+
+        except ImportError:
+            pass
+
+    if interpreters is None:
+        pytest.skip('no subinterpreter support')
+
+    _, module = jit_build_ctx.module_for_abi(std_name, std_abi)
+
+    value = std_abi.random_of('transaction_receipt', rng=random.Random(0))
+    raw = std_abi.pack('transaction_receipt', value)
+
+    code = f'''
+from importlib.machinery import ExtensionFileLoader
+from importlib.util import spec_from_file_location, module_from_spec
+
+loader = ExtensionFileLoader({module.__name__!r}, {module.__file__!r})
+spec = spec_from_file_location(
+    {module.__name__!r}, {module.__file__!r}, loader=loader)
+module = module_from_spec(spec)
+loader.exec_module(module)
+
+raw = {raw!r}
+value = module.unpack('transaction_receipt', raw)
+assert module.pack('transaction_receipt', value) == raw
+'''
+    interp = interpreters.create()
+    try:
+        # 3.13 returns the exception info, 3.12 raises
+        assert interpreters.run_string(interp, code) is None
+
+    finally:
+        interpreters.destroy(interp)
+
+    assert module.unpack('transaction_receipt', raw) == \
+        module.unpack_transaction_receipt(raw)
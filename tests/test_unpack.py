@@ -0,0 +1,206 @@
+import sys
+
+import pytest
+
+from jitabi._testing import load_abis
+
+
+def _action_raw(std_module) -> bytes:
+    return std_module.pack('action', {
+        'account': 1,
+        'name': 2,
+        'authorization': [{'actor': 3, 'permission': 4}],
+        'data': b'\x00'
+    })
+
+
+def test_struct_keys_interned(std_module):
+    '''
+    Decoded dicts must reuse the module's interned field name keys.
+
+    '''
+    raw = _action_raw(std_module)
+    for value in (std_module.unpack_action(raw), std_module.unpack('action', raw)):
+        assert list(value) == ['account', 'name', 'authorization', 'data']
+
+        for key in value:
+            assert key is sys.intern(key)
+
+        for key in value['authorization'][0]:
+            assert key is sys.intern(key)
+
+
+def test_enum_type_tag_interned(std_module):
+    raw = b'\x00' + std_module.pack('action_receipt_v0', {
+        'receiver': 1,
+        'act_digest': bytes(32),
+        'global_sequence': 2,
+        'recv_sequence': 3,
+        'auth_sequence': [],
+        'code_sequence': 4,
+        'abi_sequence': 5
+    })
+
+    first, second = std_module.unpack_many('action_receipt', [raw, raw])
+
+    assert first['type'] == 'action_receipt_v0'
+    assert first['type'] is second['type']
+    assert next(k for k in first if k == 'type') is sys.intern('type')
+
+
+@pytest.fixture(scope='module')
+def value_cache_module(jit_build_ctx):
+    (mod_name, abi), *_ = load_abis(whitelist=['standard'])
+    _, module = jit_build_ctx.module_for_abi(
+        mod_name, abi,
+        params={'value_cache': True}
+    )
+    return module
+
+
+def test_value_cache(value_cache_module):
+    '''
+    Name-like values decoded repeatedly must reuse one object, colliding
+    slots get evicted without affecting decoded values.
+
+    '''
+    mod = value_cache_module
+    raw = (0x5530ea033482a600).to_bytes(8, 'little')
+
+    first = mod.unpack('name', raw)
+    assert first == 0x5530ea033482a600
+    assert mod.unpack('account_name', raw) is first
+
+    action = mod.unpack_action(_action_raw(mod))
+    assert action['authorization'][0]['actor'] == 3
+
+    for i in range(20_000):
+        v = (i * 0x100000001b3) & 0xffffffffffffffff
+        assert mod.unpack('symbol', v.to_bytes(8, 'little')) == v
+
+    assert mod.unpack('name', raw) == first
+
+
+@pytest.fixture(scope='module')
+def name_strings_module(jit_build_ctx):
+    (mod_name, abi), *_ = load_abis(whitelist=['standard'])
+    _, module = jit_build_ctx.module_for_abi(
+        mod_name, abi,
+        params={'name_strings': True}
+    )
+    return module
+
+
+@pytest.mark.parametrize(
+    'type_name,value,expected',
+    [
+        ('name', 0x5530ea033482a600, 'eosio.token'),
+        ('name', 0x5530ea0000000000, 'eosio'),
+        ('name', 0, ''),
+        ('account_name', 0xffffffffffffffff, 'zzzzzzzzzzzzj'),
+        ('symbol', 0x534f4504, '4,EOS'),
+        ('symbol_code', 0x534f45, 'EOS'),
+    ]
+)
+def test_name_strings(name_strings_module, type_name, value, expected):
+    mod = name_strings_module
+    raw = value.to_bytes(8, 'little')
+
+    assert mod.unpack(type_name, raw) == expected
+    assert mod.pack(type_name, expected) == raw
+
+    # raw ints are still accepted
+    assert mod.pack(type_name, value) == raw
+
+
+def test_name_strings_non_canonical(name_strings_module):
+    '''
+    Symbols without a string form decode to their raw int so they still
+    round trip.
+
+    '''
+    mod = name_strings_module
+
+    for type_name, value in (('symbol_code', 0x01), ('symbol', 0x0104)):
+        raw = value.to_bytes(8, 'little')
+        assert mod.unpack(type_name, raw) == value
+        assert mod.pack(type_name, mod.unpack(type_name, raw)) == raw
+
+
+@pytest.mark.parametrize(
+    'type_name,value',
+    [
+        ('name', 'EOSIO'),
+        ('name', 'a' * 14),
+        ('name', 'zzzzzzzzzzzzz'),
+        ('symbol', 'EOS'),
+        ('symbol', '256,EOS'),
+        ('symbol_code', 'eos'),
+        ('symbol_code', 'ABCDEFGH'),
+    ]
+)
+def test_name_strings_invalid(name_strings_module, type_name, value):
+    with pytest.raises(ValueError):
+        name_strings_module.pack(type_name, value)
+
+
+@pytest.mark.parametrize(
+    'type_name,raw',
+    [
+        ('varuint32', b''),
+        ('varuint32', b'\x80'),
+        ('varuint32', b'\xff' * 5 + b'\x01'),
+        ('varint32', b'\xff\xff'),
+        ('string', b'\x05abc'),
+        ('bytes', b'\xff\xff\xff\xff\x0f'),
+        ('uint8[]', b'\x80\x80'),
+    ]
+)
+def test_truncated_varints(std_module, type_name, raw):
+    with pytest.raises(ValueError):
+        std_module.unpack(type_name, raw)
+
+
+def test_varint_boundaries(std_module):
+    for value in (0, 0x7f, 0x80, 0x3fff, 0x4000, 2**28 - 1, 2**28, 2**32 - 1):
+        raw = std_module.pack('varuint32', value)
+        assert std_module.unpack('varuint32', raw) == value
+        # trailing bytes must not leak into the decoded value
+        assert std_module.unpack_from('varuint32', raw + b'\xff' * 8)[0] == value
+
+    for value in (0, -1, 63, -64, 64, -65, 2**31 - 1, -2**31):
+        assert std_module.unpack('varint32', std_module.pack('varint32', value)) == value
+
+    with pytest.raises(OverflowError):
+        std_module.pack('varuint32', 2**32)
+
+    with pytest.raises(OverflowError):
+        std_module.pack('varint32', 2**31)
+
+
+def test_fixed_layout_structs(std_module):
+    '''
+    Fixed size structs decode & encode at constant offsets, base fields
+    included, and reject short buffers as a whole.
+
+    '''
+    value = {
+        'quantity': {'amount': -5, 'symbol': 0x534f4504},
+        'contract': 0x5530ea033482a600
+    }
+    raw = (
+        (-5).to_bytes(8, 'little', signed=True)
+        + (0x534f4504).to_bytes(8, 'little')
+        + (0x5530ea033482a600).to_bytes(8, 'little')
+    )
+
+    assert std_module.pack('extended_asset', value) == raw
+    assert std_module.unpack('extended_asset', raw) == value
+    assert std_module.unpack_from('extended_asset', raw + b'\xff') == (value, 24)
+    assert std_module.unpack('extended_asset[]', b'\x02' + raw * 2) == [value] * 2
+
+    with pytest.raises(RuntimeError):
+        std_module.unpack('extended_asset', raw[:-1])
+
+    with pytest.raises(KeyError):
+        std_module.pack('asset', {'amount': 1})